@@ -16,6 +16,9 @@
 // 全局配置变量的实体定义
 SystemConfiguration g_system_config;
 
+volatile uint32_t g_channel_client_mask = 0;
+volatile uint32_t g_channel_active_mask = 0;
+
 /* ------------------ Private Function Prototypes ------------------ */
 static int read_config_from_flash(SystemConfiguration* config);
 static int write_config_to_flash(const SystemConfiguration* config);
@@ -81,6 +84,7 @@ void dev_config_print(void) {
 		/* --- 循环打印每个通道的设置和状态 --- */
 		for (i = 0; i < NUM_PORTS; i++) {
 			ChannelState* ch = &g_system_config.channels[i];
+			ChannelRuntime* rt = &g_system_config.runtime[i];
 			LOG_INFO("[Channel %d Settings & Status]", i + 1);
 
 			// 打印配置参数
@@ -100,6 +104,10 @@ void dev_config_print(void) {
 			LOG_INFO("    - Command Channel: State=%s, Clients=%d/%d",
 					net_state_to_string(ch->cmd_net_info.state),
 					ch->cmd_net_info.num_clients, MAX_CLIENTS_PER_CHANNEL);
+			LOG_INFO("    - Overflow: Policy=%d, RX Dropped=%u, TX Dropped=%u",
+					ch->overflow_policy, rt->rx_drop_count, rt->tx_drop_count);
+			LOG_INFO("    - Client Lag: Limit=%d%%, Action=%d, Skipped=%u",
+					ch->client_lag_limit_pct, ch->client_lag_action, ch->lag_drop_count);
 
 			LOG_INFO(
 					"------------------------------------------------------------");
@@ -173,6 +181,9 @@ static void dev_config_init_channel_defaults(ChannelState* ch,
 	// --- 2. 设置默认的操作模式 ---
 	ch->op_mode = DEFAULT_COM_OP_MODE;
 	ch->interface_type = DEFAULT_COM_INTERFACE_TYPE;
+	ch->overflow_policy = DEFAULT_COM_OVERFLOW_POLICY;
+	ch->client_lag_limit_pct = DEFAULT_COM_CLIENT_LAG_LIMIT_PCT;
+	ch->client_lag_action = DEFAULT_COM_CLIENT_LAG_ACTION;
 
 	// --- 3. 设置通用的串口和网络参数 ---
 	ch->baudrate = DEFAULT_COM_BAUDRATE;
@@ -180,6 +191,7 @@ static void dev_config_init_channel_defaults(ChannelState* ch,
 	ch->stop_bits = 1;
 	ch->parity = 0;
 	ch->flow_ctrl = 0;
+	ch->rx_fifo_trigger = DEFAULT_COM_RX_FIFO_TRIGGER;
 	ch->tcp_alive_check_time_min = DEFAULT_REAL_COM_TCP_ALIVE_CHECK_MIN; // 通用
 	ch->inactivity_time_ms = DEFAULT_TCPSERVER_INACTIVITY_TIME_MS; // 通用
 	ch->ignore_jammed_ip = DEFAULT_REAL_COM_IGNORE_JAMMED_IP; // 通用
@@ -243,6 +255,7 @@ static void dev_config_init_channel_defaults(ChannelState* ch,
 	ch->packing_settings.delimiter_process = DEFAULT_REAL_COM_DELIMITER_PROCESS;
 	ch->packing_settings.force_transmit_time_ms =
 			DEFAULT_REAL_COM_FORCE_TRANSMIT_TIME;
+	ch->packing_settings.char_gap = DEFAULT_REAL_COM_CHAR_GAP;
 }
 
 void dev_config_load_defaults(void) {
@@ -295,6 +308,23 @@ void dev_config_load_defaults(void) {
 	}
 }
 
+void dev_channel_activity_update(int channel_index) {
+	ChannelState* ch = &g_system_config.channels[channel_index];
+	uint32_t bit = (1u << channel_index);
+
+	// 各任务分别修改不同通道的位，用原子操作避免互相覆盖
+	if (ch->data_net_info.num_clients > 0) {
+		__atomic_fetch_or(&g_channel_client_mask, bit, __ATOMIC_SEQ_CST);
+	} else {
+		__atomic_fetch_and(&g_channel_client_mask, ~bit, __ATOMIC_SEQ_CST);
+	}
+	if (ch->data_net_info.num_clients > 0 && ch->uart_state == UART_STATE_OPENED) {
+		__atomic_fetch_or(&g_channel_active_mask, bit, __ATOMIC_SEQ_CST);
+	} else {
+		__atomic_fetch_and(&g_channel_active_mask, ~bit, __ATOMIC_SEQ_CST);
+	}
+}
+
 void dev_reboot(void) {
 	LOG_INFO("System rebooting...\n");
 	// TODO: 调用BSP或硬件驱动提供的系统重启函数
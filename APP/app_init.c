@@ -14,10 +14,12 @@
 #include "./inc/app_udp_search.h"
 #include "./inc/app_net_cfg.h"
 #include "./inc/app_net_scheduler.h"
+#include "./HAL/hal_timer.h"
 
 /* ------------------ Task Configuration Constants ------------------ */
 // 任务优先级 (数字越小，优先级越高)
 #define REALTIME_SCHEDULER_PRIORITY   55
+#define NET_SCHEDULER_PRIORITY        56
 #define CONFIG_TASK_MANAGER_PRIORITY  60
 #define CONN_MANAGER_PRIORITY         70
 #define UDP_SEARCH_PRIORITY           75
@@ -31,15 +33,13 @@
 // 计算配置队列的最大容量
 #define CONFIG_QUEUE_CAPACITY (DATA_QUEUE_CAPACITY)
 
-#define MAX_MSG_IN_Q 24
-
 MSG_Q_ID g_config_conn_q;
-MSG_Q_ID g_net_conn_q[NUM_PORTS];
 MSG_Q_ID g_serial_port_ctrl_q[NUM_PORTS];
 /* ------------------ Global Variable Definitions ------------------ */
 SEM_ID g_config_mutex;
 TASK_ID g_conn_manager_tid;
 TASK_ID g_realtime_scheduler_tid;
+TASK_ID g_net_scheduler_tid;
 TASK_ID g_config_task_manager_tid;
 TASK_ID g_udp_search_tid;
 /**
@@ -59,13 +59,7 @@ void app_start(void) {
 
 	// 创建消息队列
 	// 参数: maxMsgs, maxMsgLength, options
-    for (i = 0; i < NUM_PORTS; i++) {
-        g_net_conn_q[i] = msgQCreate(MAX_MSG_IN_Q, sizeof(NewConnectionMsg), MSG_Q_FIFO);
-        if (g_net_conn_q[i] == NULL) {
-            // 错误处理: 记录日志或停止系统
-            LOG_ERROR("Failed to create message queue for channel %d\n", i);
-        }
-    }
+    // (数据连接经 net_scheduler_handoff() 的无锁邮箱交给网络调度任务，不使用消息队列)
 	g_config_conn_q = msgQCreate(DATA_QUEUE_CAPACITY,sizeof(NewConnectionMsg), MSG_Q_FIFO);
 
 	if (g_config_conn_q == NULL) {
@@ -86,7 +80,14 @@ void app_start(void) {
 
 	dev_network_settings_apply("192.168.8.220", "255.255.255.0", "192.168.8.1",0);
 
+	// 时间戳计数器用于执行时间和网络延迟统计
+	hal_timestamp_init();
+
 	/* ------------------ 2. 初始化通道状态 ------------------ */
+	if (buf_pool_init() != OK) {
+		LOG_ERROR("FATAL: Failed to initialize channel buffer pool.\n");
+		return;
+	}
 	LOG_INFO("Initializing channel states...\n");
 	for (i = 0; i < NUM_PORTS; i++) {
 		// *** 状态维护：明确设置所有通道的初始物理状态为关闭 ***
@@ -96,9 +97,8 @@ void app_start(void) {
 		{
 			g_system_config.channels[i].data_net_info.client_fds[j] = -1;	
 		}
-		// 初始化环形缓冲区
-		ring_buffer_init(&g_system_config.channels[i].buffer_net,  g_system_config.channels[i].net_buffer_mem,  RING_BUFFER_SIZE);
-		ring_buffer_init(&g_system_config.channels[i].buffer_uart, g_system_config.channels[i].uart_buffer_mem, RING_BUFFER_SIZE);
+		// 环形缓冲区的存储区在第一个数据客户端接入时从缓冲池分配
+		memset(&g_system_config.runtime[i], 0, sizeof(ChannelRuntime));
 	}
 	LOG_INFO("All %d channel states initialized.\n", NUM_PORTS);
 
@@ -118,6 +118,12 @@ void app_start(void) {
                                          0, DEFAULT_STACK_SIZE,
                                          (FUNCPTR)RealTimeSchedulerTask,
                                          0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+	// 创建 NetworkSchedulerTask (由网络事件驱动，不再由实时调度任务周期调用)
+    g_net_scheduler_tid = taskSpawn("tNetScheduler",
+                                    NET_SCHEDULER_PRIORITY,
+                                    0, DEFAULT_STACK_SIZE,
+                                    (FUNCPTR)NetworkSchedulerTask,
+                                    0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
    g_udp_search_tid = taskSpawn("tUdpSearch",
                                 UDP_SEARCH_PRIORITY,
                                 0, DEFAULT_STACK_SIZE,
@@ -125,7 +131,8 @@ void app_start(void) {
                                 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
 
 	if (g_conn_manager_tid == ERROR || g_config_task_manager_tid == ERROR
-			|| g_realtime_scheduler_tid == ERROR || g_udp_search_tid == ERROR) {
+			|| g_realtime_scheduler_tid == ERROR || g_net_scheduler_tid == ERROR
+			|| g_udp_search_tid == ERROR) {
 		LOG_ERROR("FATAL: Failed to spawn one or more tasks.\n");
 		// 此处可能需要清理已创建的资源
 		return;
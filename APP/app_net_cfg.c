@@ -119,7 +119,7 @@ void ConfigTaskManager(void)
         }
 
         /* ------------------ 3. 阻塞等待事件 ------------------ */
-        struct timeval timeout = { 5, 0 }; // 5秒超时
+        struct timeval timeout = { 1, 0 }; // 1秒超时 (同时决定溢出通知的最大延迟)
         int ret = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
 
         if (ret < 0) {
@@ -150,6 +150,11 @@ void ConfigTaskManager(void)
                 cleanup_config_connection(i);
             }
         }
+
+        /* ------------------ 5. 向驱动上报缓冲区溢出 ------------------ */
+        for (i = 0; i < NUM_PORTS; i++) {
+            usart_report_sw_overrun(i);
+        }
     }
 }
 
@@ -327,6 +332,7 @@ static void cleanup_config_connection(int index)
             // *** 检查数据通道是否也已没有客户端 ***
             if (channel->data_net_info.num_clients == 0) {
                 channel->uart_state = UART_STATE_CLOSED;
+                dev_channel_activity_update(channel_index);
                 LOG_INFO("ConfigTask: All network clients for Ch %d disconnected. UART physical state -> CLOSED.\n", channel_index);
             }
         }
@@ -9,9 +9,10 @@
  * - 启动时根据全局配置 g_system_config 初始化所有16个通道的网络服务。
  * - 统一监听所有 TCP Server 端口，并接受（accept）新的客户端连接。
  * - 在接受新连接前，检查并实施每个通道的最大连接数限制。
- * - 统一管理所有 TCP Client 的非阻塞连接（connect）过程。
- * - 将所有准备就绪（已连接或已绑定）的 socket 文件描述符 (fd) 通过消息队列
- * 准确地分发给对应的上层业务任务（如 RealTimeSchedulerTask）。
+ * - 统一管理所有 TCP Client 的非阻塞连接（connect）过程。每个目标各自维护
+ * 连接状态和重连退避，一个目标不可达不影响其他目标。
+ * - 将所有准备就绪（已连接或已绑定）的数据 socket 文件描述符 (fd) 通过无锁邮箱
+ * (net_scheduler_handoff) 交给网络调度任务，配置连接通过消息队列交给 ConfigTaskManager。
  * - 监听一个控制消息队列，以支持对任意通道进行动态的网络模式切换，并处理
  * 来自业务任务的连接关闭通知。
  *
@@ -28,6 +29,7 @@
 #include <sockLib.h>
 #include <inetLib.h>
 #include <selectLib.h>
+#include <tickLib.h>
 #include <fcntl.h>
 #include <errnoLib.h>
 #include <string.h>
@@ -35,6 +37,8 @@
 
 #include "./inc/app_net_con.h" // 模块自身的公共头文件
 #include "./inc/app_com.h"     // 包含 SystemConfiguration, NewConnectionMsg 等核心结构
+#include "./inc/app_uart.h"    // calculate_buffer_size, calculate_send_parameters
+#include "./inc/app_net_scheduler.h" // net_scheduler_handoff
 
 /* ================================================================================
  * 宏定义与内部数据结构
@@ -46,6 +50,14 @@
 #define MANAGER_TASK_STACK_SIZE 8192 // 为网络操作提供充足的栈空间
 #define MANAGER_CTRL_MSG_Q_SIZE 20   // 控制消息队列深度，以应对突发命令
 
+// TCP Client 重连
+#define TCP_CLIENT_MAX_DESTS          (4)     // tcp_destinations[] 的项数
+#define TCP_CLIENT_CONNECT_TIMEOUT_MS (5000)  // 非阻塞 connect() 超过该时间仍未完成即放弃，按退避重连
+#define TCP_CLIENT_RETRY_MIN_MS       (1000)  // 连接失败或断开后的首次重连间隔
+#define TCP_CLIENT_RETRY_MAX_MS       (30000) // 连续失败时重连间隔逐次翻倍，直到该上限
+#define DEST_FD_NONE                  (-1)    // s_dest_fd: 目标没有交给网络调度任务的连接
+#define DEST_FD_CLOSED                (-2)    // s_dest_fd: 网络调度任务已关闭该目标的连接，等待重连
+
 // 内部使用的 "监听Socket映射表"，用于通过 listen_fd 快速反查其来源信息
 typedef struct {
     int             listen_fd;
@@ -58,10 +70,26 @@ typedef struct {
 typedef struct {
     int             socket_fd;
     int             channel_index;
+    int             dest_index;    // tcp_destinations[] 的下标
     ConnectionType  conn_type;
     BOOL            is_in_use;
 } PendingConnection;
 
+// TCP Client 单个目标的连接状态
+typedef enum {
+    DEST_STATE_IDLE,        // 未配置，或通道不在 TCP Client 模式
+    DEST_STATE_CONNECTING,  // 非阻塞 connect() 进行中，fd 在待连接列表中
+    DEST_STATE_CONNECTED,   // fd 已交给网络调度任务
+    DEST_STATE_BACKOFF      // 等待 deadline 到达后重连
+} TcpDestState;
+
+typedef struct {
+    TcpDestState state;
+    int          fd;        // CONNECTING/CONNECTED 状态下的 socket
+    ULONG        deadline;  // CONNECTING: 连接超时时刻; BACKOFF: 重连时刻 (tick)
+    ULONG        backoff;   // 下一次失败后的退避间隔 (tick)
+} TcpDestination;
+
 #define MAX_LISTENERS           (16 * 4 + 1) // 16串口*2(RealCom)+1全局配置
 #define MAX_PENDING_CONNECTIONS (16 * 8)     // 16串口*8(TCP Client)
 
@@ -76,10 +104,14 @@ static MSG_Q_ID g_manager_ctrl_q  = NULL; // 接收控制命令的消息队列
 static ListenerMap       g_listener_map[MAX_LISTENERS];
 static PendingConnection g_pending_connections[MAX_PENDING_CONNECTIONS];
 static int               g_active_tcp_connections[NUM_PORTS]; // 跟踪每个通道的活跃TCP连接数
+static TcpDestination    g_tcp_dests[NUM_PORTS][TCP_CLIENT_MAX_DESTS];
+
+// 各 TCP Client 目标交给网络调度任务的连接 fd，与网络调度任务共享 (__atomic 访问)。
+// 网络调度任务关闭该连接时原子地改为 DEST_FD_CLOSED，断开通知不经过消息队列，不会因队列满而丢失。
+static int               s_dest_fd[NUM_PORTS][TCP_CLIENT_MAX_DESTS];
 
 // --- 外部依赖 ---
 extern SystemConfiguration g_system_config;
-extern MSG_Q_ID g_net_conn_q[NUM_PORTS];
 extern MSG_Q_ID g_serial_port_ctrl_q[NUM_PORTS];
 
 /* ================================================================================
@@ -95,8 +127,14 @@ static void handle_new_connections(fd_set* p_readfds);
 static void handle_pending_connections(fd_set* p_writefds);
 static int  create_tcp_listener(int port);
 static void add_to_listener_map(int fd, int ch_index, ConnectionType type);
-static void add_to_pending_list(int fd, int ch_index, ConnectionType type);
+static void add_to_pending_list(int fd, int ch_index, int dest_index, ConnectionType type);
 static void remove_from_pending_list(int fd);
+static ULONG ms_to_ticks(unsigned int ms);
+static void tcp_dest_connect(int channel_index, int dest_index);
+static void tcp_dest_dispatch(int channel_index, int dest_index, int fd);
+static void tcp_dest_backoff(int channel_index, int dest_index);
+static void service_tcp_destinations(void);
+static void tcp_dest_set_fd(int channel_index, int dest_index, int fd);
 
 
 /* ================================================================================
@@ -149,20 +187,35 @@ STATUS ConnectionManager_NotifyConnectionClosed(int channel_index) {
     return msgQSend(g_manager_ctrl_q, (char*)&msg, sizeof(msg), NO_WAIT, MSG_PRI_NORMAL);
 }
 
+STATUS ConnectionManager_NotifyDestinationClosed(int channel_index, int dest_index, int client_fd) {
+    if (channel_index < 0 || channel_index >= NUM_PORTS) return ERROR;
+    if (dest_index < 0 || dest_index >= TCP_CLIENT_MAX_DESTS) return ERROR;
+
+    // 只标记目标当前的连接；通道重新配置之前的旧连接此时已不在 s_dest_fd 中，比较失败即忽略
+    int expected = client_fd;
+    __atomic_compare_exchange_n(&s_dest_fd[channel_index][dest_index], &expected, DEST_FD_CLOSED,
+                                0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    return OK;
+}
+
 /* ================================================================================
  * 任务主函数
  * ================================================================================ */
 
 static void ConnectionManagerTask(void) {
-    int i;
+    int i, j;
     LOG_INFO("Connection Manager Task entering main loop.\n");
 
     // --- 1. 初始化 ---
     memset(g_listener_map, 0, sizeof(g_listener_map));
     memset(g_pending_connections, 0, sizeof(g_pending_connections));
     memset(g_active_tcp_connections, 0, sizeof(g_active_tcp_connections));
+    memset(g_tcp_dests, 0, sizeof(g_tcp_dests));
     
     for (i = 0; i < NUM_PORTS; i++) {
+        for (j = 0; j < TCP_CLIENT_MAX_DESTS; j++) {
+            tcp_dest_set_fd(i, j, DEST_FD_NONE);
+        }
         setup_channel(i);
     }
     
@@ -198,6 +251,9 @@ static void ConnectionManagerTask(void) {
             perror("ConnectionManager: select() error");
             taskDelay(sysClkRateGet());
         }
+
+        // 连接超时与到期的重连，粒度为一次 select() 超时
+        service_tcp_destinations();
     }
 }
 
@@ -207,7 +263,8 @@ static void ConnectionManagerTask(void) {
 
 static void process_control_messages(void) {
     ManagerCtrlMsg msg;
-    if (msgQReceive(g_manager_ctrl_q, (char*)&msg, sizeof(msg), NO_WAIT) == OK) {
+    // 每轮取空队列，突发的命令不会在 select() 超时之间积压
+    while (msgQReceive(g_manager_ctrl_q, (char*)&msg, sizeof(msg), NO_WAIT) == sizeof(msg)) {
         switch (msg.cmd_type) {
             case CTRL_CMD_RECONFIGURE_CHANNEL:
                 LOG_DEBUG("Received reconfigure command for channel %d.\n", msg.channel_index);
@@ -256,6 +313,7 @@ static void handle_new_connections(fd_set* p_readfds)
                 msg.client_fd = client_fd;
                 msg.channel_index = g_listener_map[i].channel_index;
                 msg.type = g_listener_map[i].conn_type;
+                msg.dest_index = -1;
                 // 根据 conn_type 决定派发到哪个队列 ---
                 switch (msg.type)
                 {
@@ -284,7 +342,7 @@ static void handle_new_connections(fd_set* p_readfds)
                     default:
                     {
                         LOG_DEBUG("Dispatching DATA connection (fd=%d) to NetSchedulerTask channel %d.\n", client_fd, msg.channel_index);
-                        if (msgQSend(g_net_conn_q[msg.channel_index], (char*)&msg, sizeof(msg), NO_WAIT, MSG_PRI_NORMAL) != OK) {
+                        if (net_scheduler_handoff(&msg) != OK) {
                             LOG_ERROR("Failed to dispatch DATA fd=%d. Closing.\n", client_fd);
                             close(client_fd);
                             g_active_tcp_connections[msg.channel_index]--;
@@ -311,19 +369,14 @@ static void handle_pending_connections(fd_set* p_writefds) {
             remove_from_pending_list(fd);
             
             if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (char*)&err, &len) == 0 && err == 0) {
-                LOG_DEBUG("TCP Client (fd=%d) connected for channel %d.\n", fd, temp_pending[i].channel_index);
-                NewConnectionMsg msg;
-                msg.client_fd = fd;
-                msg.channel_index = temp_pending[i].channel_index;
-                msg.type = temp_pending[i].conn_type;
-                    
-                if (msgQSend(g_net_conn_q[msg.channel_index], (char*)&msg, sizeof(msg), NO_WAIT, MSG_PRI_NORMAL) != OK) {
-                     LOG_ERROR("Failed to dispatch connected fd=%d. Closing.\n", fd);
-                     close(fd);
-                }
+                LOG_DEBUG("TCP Client (fd=%d) connected for channel %d dest %d.\n",
+                          fd, temp_pending[i].channel_index, temp_pending[i].dest_index);
+                tcp_dest_dispatch(temp_pending[i].channel_index, temp_pending[i].dest_index, fd);
             } else {
-                LOG_ERROR("TCP Client (fd=%d) failed for channel %d: %s\n", fd, temp_pending[i].channel_index, strerror(err));
+                LOG_ERROR("TCP Client (fd=%d) failed for channel %d dest %d: %s\n",
+                          fd, temp_pending[i].channel_index, temp_pending[i].dest_index, strerror(err));
                 close(fd);
+                tcp_dest_backoff(temp_pending[i].channel_index, temp_pending[i].dest_index);
             }
         }
     }
@@ -346,6 +399,11 @@ static void teardown_channel(int channel_index) {
             g_pending_connections[i].is_in_use = FALSE;
         }
     }
+    // 已交给网络调度任务的连接由其关闭，届时的断开通知会被忽略
+    memset(g_tcp_dests[channel_index], 0, sizeof(g_tcp_dests[channel_index]));
+    for (i = 0; i < TCP_CLIENT_MAX_DESTS; i++) {
+        tcp_dest_set_fd(channel_index, i, DEST_FD_NONE);
+    }
     g_active_tcp_connections[channel_index] = 0;
     LOG_DEBUG("Network resources for channel %d torn down.\n", channel_index);
 }
@@ -353,6 +411,11 @@ static void teardown_channel(int channel_index) {
 static void setup_channel(int channel_index) {
     ChannelState* cfg = &g_system_config.channels[channel_index];
 
+    // 环形缓冲区容量随工作模式和波特率变化，在第一个数据客户端接入时从缓冲池分配
+    calculate_buffer_size(cfg);
+    // 按波特率估算的发送间隔/包大小，作为自适应批量的初值
+    calculate_send_parameters(cfg);
+
     switch (cfg->op_mode) {
         case OP_MODE_REAL_COM: 
         {
@@ -378,33 +441,10 @@ static void setup_channel(int channel_index) {
         }
         case OP_MODE_TCP_CLIENT: {
         	int j;
-            for (j = 0; j < 4; j++) {
+            for (j = 0; j < TCP_CLIENT_MAX_DESTS; j++) {
                 if (cfg->tcp_destinations[j].destination_ip == 0 || cfg->tcp_destinations[j].destination_port == 0) continue;
-                
-                int client_fd = socket(AF_INET, SOCK_STREAM, 0);
-                if (client_fd < 0) continue;
-                
-                fcntl(client_fd, F_SETFL, O_NONBLOCK);
-                
-                struct sockaddr_in server_addr = {0};
-                server_addr.sin_family = AF_INET;
-                server_addr.sin_port = htons(cfg->tcp_destinations[j].destination_port);
-                server_addr.sin_addr.s_addr = cfg->tcp_destinations[j].destination_ip;
-                
-                if (connect(client_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-                    if (errno == EINPROGRESS) {
-                        add_to_pending_list(client_fd, channel_index, CONN_TYPE_TCPCLIENT);
-                    } else {
-                        perror("connect() error");
-                        close(client_fd);
-                    }
-                } else {
-                     NewConnectionMsg msg;
-                     msg.client_fd = client_fd;
-                     msg.channel_index = channel_index;
-                     msg.type = CONN_TYPE_TCPCLIENT;
-                     msgQSend(g_net_conn_q[channel_index], (char*)&msg, sizeof(msg), NO_WAIT, MSG_PRI_NORMAL);
-                }
+                g_tcp_dests[channel_index][j].backoff = ms_to_ticks(TCP_CLIENT_RETRY_MIN_MS);
+                tcp_dest_connect(channel_index, j);
             }
             break;
         }
@@ -412,17 +452,26 @@ static void setup_channel(int channel_index) {
             int udp_fd = socket(AF_INET, SOCK_DGRAM, 0);
             if (udp_fd < 0) break;
             
+            // 目的地址范围可能包含子网广播地址
+            int opt = 1;
+            setsockopt(udp_fd, SOL_SOCKET, SO_BROADCAST, (char*)&opt, sizeof(opt));
+
+            // 在本地监听端口接收各目的地址发回的数据，发送也从该端口发出
             struct sockaddr_in addr = {0};
             addr.sin_family = AF_INET;
             addr.sin_addr.s_addr = htonl(INADDR_ANY);
-            addr.sin_port = htons(cfg->udp_destinations[0].port);
+            addr.sin_port = htons(cfg->local_udp_listen_port);
             
             if (bind(udp_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
                 NewConnectionMsg msg;
                 msg.client_fd = udp_fd;
                 msg.channel_index = channel_index;
                 msg.type = CONN_TYPE_UDP;
-                msgQSend(g_net_conn_q[channel_index], (char*)&msg, sizeof(msg), NO_WAIT, MSG_PRI_NORMAL);
+                msg.dest_index = -1;
+                if (net_scheduler_handoff(&msg) != OK) {
+                    LOG_ERROR("Failed to dispatch UDP fd=%d. Closing.\n", udp_fd);
+                    close(udp_fd);
+                }
             } else {
                 perror("UDP bind failed");
                 close(udp_fd);
@@ -472,14 +521,15 @@ static void add_to_listener_map(int fd, int ch_index, ConnectionType type) {
     LOG_ERROR("Listener map is full! Cannot add fd %d.\n", fd);
 }
 
-static void add_to_pending_list(int fd, int ch_index, ConnectionType type) {\
+static void add_to_pending_list(int fd, int ch_index, int dest_index, ConnectionType type) {
 	int i;
     for ( i = 0; i < MAX_PENDING_CONNECTIONS; i++) {
         if (!g_pending_connections[i].is_in_use) {
-            g_listener_map[i].listen_fd = fd;
-            g_listener_map[i].channel_index = ch_index;
-            g_listener_map[i].conn_type = type;
-            g_listener_map[i].is_in_use = TRUE;
+            g_pending_connections[i].socket_fd = fd;
+            g_pending_connections[i].channel_index = ch_index;
+            g_pending_connections[i].dest_index = dest_index;
+            g_pending_connections[i].conn_type = type;
+            g_pending_connections[i].is_in_use = TRUE;
             return;
         }
     }
@@ -495,3 +545,140 @@ static void remove_from_pending_list(int fd) {
         }
     }
 }
+
+static ULONG ms_to_ticks(unsigned int ms) {
+    ULONG ticks = ((ULONG)ms * sysClkRateGet() + 999) / 1000;
+    return (ticks > 0) ? ticks : 1;
+}
+
+/**
+ * @brief 向一个 TCP Client 目标发起非阻塞连接
+ * @details 立即连上时直接交给网络调度任务；EINPROGRESS 时放入待连接列表，
+ * 由 select() 的可写事件或连接超时结束；其他错误按退避间隔重试。
+ */
+static void tcp_dest_connect(int channel_index, int dest_index) {
+    TCP_Client_Mode_Settings* dest = &g_system_config.channels[channel_index].tcp_destinations[dest_index];
+    TcpDestination* d = &g_tcp_dests[channel_index][dest_index];
+
+    int client_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (client_fd < 0) {
+        perror("socket()");
+        tcp_dest_backoff(channel_index, dest_index);
+        return;
+    }
+    fcntl(client_fd, F_SETFL, O_NONBLOCK);
+
+    // 指定了本地端口时先绑定；重连时旧连接可能仍在 TIME_WAIT，需要 SO_REUSEADDR
+    if (dest->designated_local_port != 0) {
+        struct sockaddr_in local_addr = {0};
+        int opt = 1;
+        setsockopt(client_fd, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt));
+        local_addr.sin_family = AF_INET;
+        local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        local_addr.sin_port = htons(dest->designated_local_port);
+        if (bind(client_fd, (struct sockaddr*)&local_addr, sizeof(local_addr)) < 0) {
+            LOG_ERROR("TCP Client ch %d dest %d: bind local port %d failed.\n",
+                      channel_index, dest_index, dest->designated_local_port);
+            close(client_fd);
+            tcp_dest_backoff(channel_index, dest_index);
+            return;
+        }
+    }
+
+    struct sockaddr_in server_addr = {0};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(dest->destination_port);
+    server_addr.sin_addr.s_addr = htonl(dest->destination_ip); // 配置中的 IP 为主机字节序
+
+    if (connect(client_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) == 0) {
+        tcp_dest_dispatch(channel_index, dest_index, client_fd);
+    } else if (errno == EINPROGRESS) {
+        add_to_pending_list(client_fd, channel_index, dest_index, CONN_TYPE_TCPCLIENT);
+        d->state = DEST_STATE_CONNECTING;
+        d->fd = client_fd;
+        d->deadline = tickGet() + ms_to_ticks(TCP_CLIENT_CONNECT_TIMEOUT_MS);
+    } else {
+        perror("connect() error");
+        close(client_fd);
+        tcp_dest_backoff(channel_index, dest_index);
+    }
+}
+
+/**
+ * @brief 把已连上的 TCP Client socket 交给网络调度任务
+ * @details 每个目标在调度任务中占一个客户端槽位，有各自的读游标，
+ * 慢或失联的目标按 client_lag_action 处理，不会拖住其他目标。
+ */
+static void tcp_dest_dispatch(int channel_index, int dest_index, int fd) {
+    TcpDestination* d = &g_tcp_dests[channel_index][dest_index];
+    NewConnectionMsg msg;
+
+    msg.client_fd = fd;
+    msg.channel_index = channel_index;
+    msg.type = CONN_TYPE_TCPCLIENT;
+    msg.dest_index = dest_index;
+    // 先登记再交接，网络调度任务收到后随时可能关闭该连接
+    tcp_dest_set_fd(channel_index, dest_index, fd);
+    if (net_scheduler_handoff(&msg) != OK) {
+        LOG_ERROR("Failed to dispatch connected fd=%d. Closing.\n", fd);
+        close(fd);
+        tcp_dest_backoff(channel_index, dest_index);
+        return;
+    }
+    d->state = DEST_STATE_CONNECTED;
+    d->fd = fd;
+    d->backoff = ms_to_ticks(TCP_CLIENT_RETRY_MIN_MS); // 连上后退避间隔从头开始
+}
+
+/**
+ * @brief 连接失败或断开后等待退避间隔再重连，连续失败时间隔翻倍
+ */
+static void tcp_dest_backoff(int channel_index, int dest_index) {
+    TcpDestination* d = &g_tcp_dests[channel_index][dest_index];
+    ULONG max_ticks = ms_to_ticks(TCP_CLIENT_RETRY_MAX_MS);
+
+    if (d->backoff == 0) {
+        d->backoff = ms_to_ticks(TCP_CLIENT_RETRY_MIN_MS);
+    }
+    d->state = DEST_STATE_BACKOFF;
+    d->fd = -1;
+    tcp_dest_set_fd(channel_index, dest_index, DEST_FD_NONE);
+    d->deadline = tickGet() + d->backoff;
+    d->backoff = (d->backoff * 2 < max_ticks) ? d->backoff * 2 : max_ticks;
+}
+
+/**
+ * @brief 更新与网络调度任务共享的目标连接 fd (DEST_FD_NONE 表示没有交出的连接)
+ */
+static void tcp_dest_set_fd(int channel_index, int dest_index, int fd) {
+    __atomic_store_n(&s_dest_fd[channel_index][dest_index], fd, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 处理已断开的连接、超时未完成的连接和到期的重连
+ */
+static void service_tcp_destinations(void) {
+    ULONG now = tickGet();
+    int i, j;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        if (g_system_config.channels[i].op_mode != OP_MODE_TCP_CLIENT) continue;
+
+        for (j = 0; j < TCP_CLIENT_MAX_DESTS; j++) {
+            TcpDestination* d = &g_tcp_dests[i][j];
+
+            if (d->state == DEST_STATE_CONNECTED
+                    && __atomic_load_n(&s_dest_fd[i][j], __ATOMIC_ACQUIRE) == DEST_FD_CLOSED) {
+                LOG_DEBUG("TCP Client ch %d dest %d disconnected, reconnecting.\n", i, j);
+                tcp_dest_backoff(i, j);
+            } else if (d->state == DEST_STATE_CONNECTING && (long)(now - d->deadline) >= 0) {
+                LOG_ERROR("TCP Client (fd=%d) timed out for channel %d dest %d.\n", d->fd, i, j);
+                remove_from_pending_list(d->fd);
+                close(d->fd);
+                tcp_dest_backoff(i, j);
+            } else if (d->state == DEST_STATE_BACKOFF && (long)(now - d->deadline) >= 0) {
+                tcp_dest_connect(i, j);
+            }
+        }
+    }
+}
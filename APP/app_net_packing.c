@@ -0,0 +1,515 @@
+/*
+ * =====================================================================================
+ *
+ * Filename:  app_net_packing.c
+ *
+ * Description:  实现“串口到网络”方向的数据打包器 (packing_length / 分隔符 / 强制发送时间)。
+ * 打包器只在 buffer_uart 上记录帧边界，帧数据不做拷贝，
+ * 发送时直接由帧记录构造指向环形缓冲区的 iovec。
+ * 字符间隔由串口接收侧 (tSerialIO) 判断，帧边界经每通道的单生产者/单消费者队列交给网络调度任务。
+ *
+ * =====================================================================================
+ */
+#include "./inc/app_com.h"
+#include "./inc/app_net_packing.h"
+#include "./inc/app_net_scheduler.h"
+#include "./HAL/hal_timer.h"
+#include <tickLib.h>
+
+/* 自由递增位置的先后比较 (两者之差不超过环形缓冲区容量) */
+#define POS_BEFORE(a, b)   ((ptrdiff_t)((a) - (b)) < 0)
+
+/* ------------------ Internal Data Structures ------------------ */
+// 一个已结束的帧: [上一帧的 frame_end, payload_end) 为发出的数据，
+// [payload_end, frame_end) 为被剥离的分隔符
+typedef struct {
+    ring_buffer_size_t payload_end;
+    ring_buffer_size_t frame_end;
+} PackFrame;
+
+typedef struct {
+    PackFrame frames[PACK_MAX_FRAMES];
+    unsigned int frame_head;                // 自由递增，frames[frame_head % N] 为下一个写入位置
+    unsigned int frame_tail;                // 最早的未释放帧
+    ring_buffer_size_t frames_start;        // frames[frame_tail] 的起点
+    ring_buffer_size_t frame_start;         // 当前未结束帧的起点 (即可发送数据的结束位置)
+    ring_buffer_size_t scan_pos;            // 已扫描到的位置
+    ring_buffer_size_t last_head;           // 上次看到的 head，用于检测新数据
+    ULONG last_rx_tick;                     // 最近一次看到新数据的时间
+    unsigned char trail_left;               // Delimiter+1/+2: 分隔符之后还需等待的字节数
+    unsigned char delim1_seen;              // 两字节分隔符: scan_pos 之前的一个字节为 delimiter1
+    unsigned char frame_per_send;           // 字符间隔打包或 UDP 模式: 相邻帧不合并，每次 send() 只发一帧
+} ChannelPacker;
+
+// 字符间隔的帧边界队列: tSerialIO 为唯一生产者，网络调度任务为唯一消费者
+typedef struct {
+    ring_buffer_size_t marks[PACK_GAP_MARKS];
+    unsigned int mark_head;                 // 自由递增，tSerialIO 写
+    unsigned int mark_tail;                 // 自由递增，网络调度任务写
+    volatile UINT32 gap_us;                 // 字符间隔 (微秒)，0 表示不启用；网络调度任务按配置刷新
+    UINT32 last_rx_clock;                   // 最近一次收到数据时的接收时钟 (tSerialIO)
+} PackGapState;
+
+/* ------------------ Module-level static variables ------------------ */
+static ChannelPacker s_packer[NUM_PORTS];
+static PackGapState s_gap[NUM_PORTS];
+static volatile uint32_t s_gap_open_mask;   // 收到数据后尚未因线路空闲结束帧的通道 (tSerialIO 修改，定时器ISR读取)
+
+/* ------------------ Private Functions ------------------ */
+
+/* 毫秒换算为 tick，向上取整且不小于1 */
+static ULONG pack_ms_to_ticks(unsigned int ms)
+{
+    ULONG ticks = ((ULONG)ms * sysClkRateGet() + 999) / 1000;
+    return (ticks > 0) ? ticks : 1;
+}
+
+static int packer_frames_full(const ChannelPacker *pk)
+{
+    return (pk->frame_head - pk->frame_tail) >= PACK_MAX_FRAMES;
+}
+
+/* 结束当前帧；没有被剥离字节的相邻帧合并为一条记录 (TCP 是字节流，合并不改变帧的完整性) */
+static void packer_close(ChannelPacker *pk, ring_buffer_size_t payload_end, ring_buffer_size_t frame_end)
+{
+    if (frame_end != pk->frame_start) {
+        PackFrame *last = &pk->frames[(pk->frame_head - 1) % PACK_MAX_FRAMES];
+
+        if (!pk->frame_per_send && pk->frame_head != pk->frame_tail && last->payload_end == last->frame_end
+                && payload_end == frame_end) {
+            last->payload_end = frame_end;
+            last->frame_end = frame_end;
+        } else {
+            PackFrame *f = &pk->frames[pk->frame_head % PACK_MAX_FRAMES];
+            f->payload_end = payload_end;
+            f->frame_end = frame_end;
+            pk->frame_head++;
+        }
+    }
+    pk->frame_start = frame_end;
+    pk->trail_left = 0;
+    pk->delim1_seen = 0;
+}
+
+/* 按串口参数换算字符间隔 (微秒)：每个字符为起始位 + 数据位 + 校验位 + 停止位 */
+static UINT32 pack_gap_us(const ChannelState *ch)
+{
+    unsigned int bits;
+
+    if (ch->packing_settings.char_gap == 0 || ch->baudrate <= 0) {
+        return 0;
+    }
+    bits = 1 + ((ch->data_bits >= 5 && ch->data_bits <= 8) ? ch->data_bits : 8)
+             + ((ch->parity != 0) ? 1 : 0) + ((ch->stop_bits >= 2) ? 2 : 1);
+    return (UINT32)(((UINT64)bits * ch->packing_settings.char_gap * 1000000 + ch->baudrate - 1)
+                    / ch->baudrate);
+}
+
+/* 自上次收到数据以来的空闲时间 (微秒) */
+static UINT32 pack_gap_idle_us(const PackGapState *g, UINT32 clock)
+{
+    return hal_timestamp_to_us(clock - g->last_rx_clock);
+}
+
+/* 生产者: 记录一个帧边界，队列满时该边界并入下一帧 */
+static void pack_gap_mark(int channel_index, ring_buffer_size_t pos)
+{
+    PackGapState *g = &s_gap[channel_index];
+    unsigned int tail = __atomic_load_n(&g->mark_tail, __ATOMIC_ACQUIRE);
+
+    if (g->mark_head - tail >= PACK_GAP_MARKS) {
+        return;
+    }
+    g->marks[g->mark_head % PACK_GAP_MARKS] = pos;
+    __atomic_store_n(&g->mark_head, g->mark_head + 1, __ATOMIC_RELEASE);
+}
+
+/* 消费者: 取最早的未处理帧边界 */
+static int pack_gap_peek(PackGapState *g, ring_buffer_size_t *pos)
+{
+    if (__atomic_load_n(&g->mark_head, __ATOMIC_ACQUIRE) == g->mark_tail) {
+        return 0;
+    }
+    *pos = g->marks[g->mark_tail % PACK_GAP_MARKS];
+    return 1;
+}
+
+static void pack_gap_pop(PackGapState *g)
+{
+    __atomic_store_n(&g->mark_tail, g->mark_tail + 1, __ATOMIC_RELEASE);
+}
+
+/* 从 pos 重新开始成帧，丢弃所有帧记录 */
+static void packer_restart(ChannelPacker *pk, ring_buffer_size_t pos)
+{
+    memset(pk, 0, sizeof(ChannelPacker));
+    pk->frames_start = pos;
+    pk->frame_start = pos;
+    pk->scan_pos = pos;
+    pk->last_head = pos;
+    pk->last_rx_tick = tickGet();
+}
+
+#if PACK_SCAN_SWAR
+/* SWAR: 每个字节都为 0x01 / 0x80 的机器字 */
+#define PACK_WORD_ONES     (~0UL / 0xFF)
+#define PACK_WORD_HIGHS    (PACK_WORD_ONES * 0x80)
+
+/* 在 [p, p + n) 中查找字节 c；一次比较一个机器字，命中的字内再逐字节定位 */
+static const char *pack_scan_byte(const char *p, const char *end, unsigned char c)
+{
+    unsigned long pattern = PACK_WORD_ONES * c;
+
+    // 先逐字节对齐到机器字边界
+    while (p < end && ((uintptr_t)p & (sizeof(unsigned long) - 1)) != 0) {
+        if ((unsigned char)*p == c) {
+            return p;
+        }
+        p++;
+    }
+    while (end - p >= (ptrdiff_t)sizeof(unsigned long)) {
+        unsigned long v;
+
+        // memcpy 取字避免 char* 转 unsigned long* 的别名问题，对齐后编译为单条加载指令
+        memcpy(&v, p, sizeof(v));
+        v ^= pattern;
+        // v 中存在零字节 (即存在等于 c 的字节) 时结果非0
+        if (((v - PACK_WORD_ONES) & ~v & PACK_WORD_HIGHS) != 0) {
+            break;
+        }
+        p += sizeof(unsigned long);
+    }
+    while (p < end) {
+        if ((unsigned char)*p == c) {
+            return p;
+        }
+        p++;
+    }
+    return NULL;
+}
+#else
+static const char *pack_scan_byte(const char *p, const char *end, unsigned char c)
+{
+    while (p < end) {
+        if ((unsigned char)*p == c) {
+            return p;
+        }
+        p++;
+    }
+    return NULL;
+}
+#endif /* PACK_SCAN_SWAR */
+
+/**
+ * 在 [scan_pos, scan_pos + len) 中查找分隔符。
+ * 数据最多跨越回绕点分两段，每段内先查找 delimiter1，两字节分隔符再核对其后一个字节。
+ * @return 找到时返回分隔符之后的字节数偏移 (从 scan_pos 算起)，并写出分隔符起点；未找到返回 0。
+ */
+static ring_buffer_size_t packer_find_delim(ChannelPacker *pk, ring_buffer_t *rb, ring_buffer_size_t len,
+                                            const DataPackingSettings *cfg, ring_buffer_size_t *delim_start)
+{
+    char *span[2];
+    ring_buffer_size_t span_len[2];
+    ring_buffer_size_t offset = 0;
+    int s;
+
+    ring_buffer_peek_spans_at(rb, pk->scan_pos, len, span, span_len);
+    for (s = 0; s < 2 && span_len[s] > 0; s++) {
+        const char *p = span[s];
+        const char *end = span[s] + span_len[s];
+
+        // 上一批数据 (或上一段) 以 delimiter1 结尾
+        if (pk->delim1_seen && (unsigned char)*p == cfg->delimiter2) {
+            *delim_start = pk->scan_pos + offset - 1;
+            return offset + 1;
+        }
+        pk->delim1_seen = 0;
+
+        while ((p = pack_scan_byte(p, end, cfg->delimiter1)) != NULL) {
+            ring_buffer_size_t k = offset + (ring_buffer_size_t)(p - span[s]);
+
+            if (cfg->delimiter2 == 0) {
+                *delim_start = pk->scan_pos + k;
+                return k + 1;
+            }
+            if (p + 1 == end) {
+                pk->delim1_seen = 1; // 第二个字节在下一段或下一批数据中
+                break;
+            }
+            if ((unsigned char)p[1] == cfg->delimiter2) {
+                *delim_start = pk->scan_pos + k;
+                return k + 2;
+            }
+            p++;
+        }
+        offset += span_len[s];
+    }
+    return 0;
+}
+
+/* ------------------ Public API Functions ------------------ */
+
+BOOL packer_is_passthrough(const DataPackingSettings *cfg)
+{
+    return (cfg->packing_length == 0 && cfg->delimiter1 == 0 && cfg->force_transmit_time_ms == 0
+            && cfg->char_gap == 0);
+}
+
+void packer_reset(int channel_index, ring_buffer_size_t pos)
+{
+    PackGapState *g = &s_gap[channel_index];
+
+    packer_restart(&s_packer[channel_index], pos);
+    // 旧缓冲区上的帧边界作废
+    g->mark_tail = __atomic_load_n(&g->mark_head, __ATOMIC_ACQUIRE);
+    g->gap_us = pack_gap_us(&g_system_config.channels[channel_index]);
+}
+
+ring_buffer_size_t packer_update(int channel_index, ULONG now)
+{
+    ChannelPacker *pk = &s_packer[channel_index];
+    ring_buffer_t *rb = &g_system_config.runtime[channel_index].buffer_uart;
+    const DataPackingSettings *cfg = &g_system_config.channels[channel_index].packing_settings;
+    // 先取 tail 再取 head，保证 tail <= head
+    ring_buffer_size_t tail = ring_buffer_tail(rb);
+    ring_buffer_size_t head = ring_buffer_head(rb);
+    ring_buffer_size_t max_frame = RING_BUFFER_CAPACITY(rb) / 2;
+    PackGapState *gap = &s_gap[channel_index];
+    ring_buffer_size_t mark;
+    int use_delim = (cfg->delimiter1 != 0);
+    int passthrough;
+
+    // 覆盖策略下生产者可能已越过未扫描的数据，之前的帧也已全部被覆盖，从 tail 重新开始成帧
+    if (POS_BEFORE(pk->scan_pos, tail)) {
+        packer_restart(pk, tail);
+    }
+
+    // 字符间隔按当前串口参数换算后交给接收侧
+    gap->gap_us = pack_gap_us(&g_system_config.channels[channel_index]);
+
+    // 没有分隔符时数据一直不成帧会占满缓冲区，单帧最长为容量的一半
+    if (cfg->packing_length > 0 && cfg->packing_length < max_frame) {
+        max_frame = cfg->packing_length;
+    }
+    passthrough = packer_is_passthrough(cfg);
+    // UDP 模式每帧是一个数据报，配置了打包参数时帧之间不能合并
+    pk->frame_per_send = (cfg->char_gap != 0)
+            || (!passthrough && g_system_config.channels[channel_index].op_mode == OP_MODE_UDP);
+
+    if (head != pk->last_head) {
+        pk->last_head = head;
+        pk->last_rx_tick = now;
+    }
+
+    while (!packer_frames_full(pk)) {
+        ring_buffer_size_t limit = head;
+
+        // 字符间隔: 扫描到帧边界时结束当前帧；已越过的边界 (帧已由其他条件结束或数据被覆盖) 直接丢弃
+        if (pack_gap_peek(gap, &mark)) {
+            if (!POS_BEFORE(pk->scan_pos, mark)) {
+                if (mark == pk->scan_pos) {
+                    packer_close(pk, pk->scan_pos, pk->scan_pos);
+                }
+                pack_gap_pop(gap);
+                continue;
+            }
+            if (POS_BEFORE(mark, limit)) {
+                limit = mark;
+            }
+        }
+        if (pk->scan_pos == limit) {
+            break;
+        }
+
+        ring_buffer_size_t avail = limit - pk->scan_pos;
+        ring_buffer_size_t room = max_frame - (pk->scan_pos - pk->frame_start);
+        ring_buffer_size_t n = (avail < room) ? avail : room;
+        ring_buffer_size_t delim_start;
+        ring_buffer_size_t found;
+
+        // Delimiter+1/+2: 分隔符之后的字节属于本帧
+        if (pk->trail_left > 0) {
+            n = (avail < pk->trail_left) ? avail : pk->trail_left;
+            pk->scan_pos += n;
+            pk->trail_left -= (unsigned char)n;
+            if (pk->trail_left == 0) {
+                packer_close(pk, pk->scan_pos, pk->scan_pos);
+            }
+            continue;
+        }
+
+        if (use_delim && (found = packer_find_delim(pk, rb, n, cfg, &delim_start)) > 0) {
+            pk->scan_pos += found;
+            pk->delim1_seen = 0;
+            switch (cfg->delimiter_process) {
+            case DELIMITER_PROCESS_STRIP:
+                packer_close(pk, delim_start, pk->scan_pos);
+                break;
+            case DELIMITER_PROCESS_APPEND_DELIM1:
+                pk->trail_left = 1;
+                break;
+            case DELIMITER_PROCESS_APPEND_DELIM2:
+                pk->trail_left = 2;
+                break;
+            default:
+                packer_close(pk, pk->scan_pos, pk->scan_pos);
+                break;
+            }
+            continue;
+        }
+
+        pk->scan_pos += n;
+        if (passthrough || pk->scan_pos - pk->frame_start >= max_frame) {
+            packer_close(pk, pk->scan_pos, pk->scan_pos);
+        }
+    }
+
+    // 强制发送: 超过 force_transmit_time_ms 没有新数据时结束当前帧 (含未等到的分隔符后续字节)
+    if (cfg->force_transmit_time_ms > 0 && pk->scan_pos != pk->frame_start && !packer_frames_full(pk)
+            && (long)(now - pk->last_rx_tick) >= (long)pack_ms_to_ticks(cfg->force_transmit_time_ms)) {
+        packer_close(pk, pk->scan_pos, pk->scan_pos);
+    }
+    return pk->frame_start;
+}
+
+BOOL packer_deadline(int channel_index, ULONG *deadline)
+{
+    ChannelPacker *pk = &s_packer[channel_index];
+    unsigned short ms = g_system_config.channels[channel_index].packing_settings.force_transmit_time_ms;
+
+    if (ms == 0 || pk->scan_pos == pk->frame_start) {
+        return FALSE;
+    }
+    *deadline = pk->last_rx_tick + pack_ms_to_ticks(ms);
+    return TRUE;
+}
+
+ring_buffer_size_t packer_join_pos(int channel_index)
+{
+    return s_packer[channel_index].frame_start;
+}
+
+int packer_iov(int channel_index, ring_buffer_size_t pos, ring_buffer_size_t max,
+               struct iovec *iov, int max_iov, ring_buffer_size_t *total)
+{
+    ChannelPacker *pk = &s_packer[channel_index];
+    ring_buffer_t *rb = &g_system_config.runtime[channel_index].buffer_uart;
+    unsigned int k;
+    int cnt = 0;
+
+    *total = 0;
+    for (k = pk->frame_tail; k != pk->frame_head && cnt < max_iov && *total < max; k++) {
+        const PackFrame *f = &pk->frames[k % PACK_MAX_FRAMES];
+        char *span[2];
+        ring_buffer_size_t span_len[2];
+        ring_buffer_size_t len;
+        int s;
+
+        if (!POS_BEFORE(pos, f->frame_end)) {
+            continue; // 该客户端已发完此帧
+        }
+        if (POS_BEFORE(pos, f->payload_end)) {
+            len = f->payload_end - pos;
+            if (len > max - *total) {
+                len = max - *total;
+            }
+            // 每帧的数据最多跨越回绕点分两段
+            ring_buffer_peek_spans_at(rb, pos, len, span, span_len);
+            for (s = 0; s < 2 && span_len[s] > 0; s++) {
+                if (cnt == max_iov) {
+                    return cnt;
+                }
+                iov[cnt].iov_base = span[s];
+                iov[cnt].iov_len = span_len[s];
+                *total += span_len[s];
+                cnt++;
+            }
+            if (pk->frame_per_send) {
+                break; // 一次只发一帧，使每帧成为单独的 TCP 段
+            }
+        }
+        pos = f->frame_end;
+    }
+    return cnt;
+}
+
+ring_buffer_size_t packer_advance(int channel_index, ring_buffer_size_t pos, ring_buffer_size_t accepted)
+{
+    ChannelPacker *pk = &s_packer[channel_index];
+    unsigned int k;
+
+    for (k = pk->frame_tail; k != pk->frame_head; k++) {
+        const PackFrame *f = &pk->frames[k % PACK_MAX_FRAMES];
+        ring_buffer_size_t left;
+
+        if (!POS_BEFORE(pos, f->frame_end)) {
+            continue;
+        }
+        left = POS_BEFORE(pos, f->payload_end) ? (f->payload_end - pos) : 0;
+        if (accepted < left) {
+            return pos + accepted;
+        }
+        // 本帧数据已全部发出，越过被剥离的分隔符
+        accepted -= left;
+        pos = f->frame_end;
+        if (accepted == 0) {
+            break;
+        }
+    }
+    return pos;
+}
+
+void packer_release(int channel_index, ring_buffer_size_t slowest)
+{
+    ChannelPacker *pk = &s_packer[channel_index];
+
+    while (pk->frame_tail != pk->frame_head) {
+        const PackFrame *f = &pk->frames[pk->frame_tail % PACK_MAX_FRAMES];
+
+        if (POS_BEFORE(slowest, f->frame_end)) {
+            break;
+        }
+        pk->frames_start = f->frame_end;
+        pk->frame_tail++;
+    }
+}
+
+void packer_gap_rx(int channel_index, ring_buffer_size_t start, UINT32 clock)
+{
+    PackGapState *g = &s_gap[channel_index];
+    uint32_t bit = 1u << channel_index;
+
+    // 周期性检查尚未发现空闲 (例如本周期才到期) 时，在新数据之前补记帧边界
+    // 未启用时也记录时间，刚启用时的第一帧即可按空闲结束
+    if ((s_gap_open_mask & bit) && g->gap_us != 0 && pack_gap_idle_us(g, clock) >= g->gap_us) {
+        pack_gap_mark(channel_index, start);
+    }
+    g->last_rx_clock = clock;
+    s_gap_open_mask |= bit;
+}
+
+BOOL packer_gap_pending(void)
+{
+    return (s_gap_open_mask != 0) ? TRUE : FALSE;
+}
+
+void packer_gap_poll(UINT32 clock)
+{
+    uint32_t ports = s_gap_open_mask;
+    int i;
+
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        PackGapState *g = &s_gap[i];
+
+        if (g->gap_us == 0) {
+            s_gap_open_mask &= ~(1u << i);
+        } else if (pack_gap_idle_us(g, clock) >= g->gap_us) {
+            // 线路已空闲: 在当前 head 处结束帧并立即唤醒网络调度任务
+            pack_gap_mark(i, ring_buffer_head(&g_system_config.runtime[i].buffer_uart));
+            s_gap_open_mask &= ~(1u << i);
+            net_scheduler_wake();
+        }
+    }
+}
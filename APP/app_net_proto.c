@@ -1226,6 +1226,7 @@ void handle_monitor_request(int session_index, const unsigned char* frame, int l
                     if (port_index >= 1 && port_index <= NUM_PORTS) {
                         int channel_index = port_index - 1;
                         ChannelState* ch = &g_system_config.channels[channel_index];
+                        ChannelRuntime* rt = &g_system_config.runtime[channel_index];
                         unsigned int temp_32;
                         unsigned long long temp_64;
                         
@@ -1233,13 +1234,13 @@ void handle_monitor_request(int session_index, const unsigned char* frame, int l
 
                         response[offset++] = port_index;
 
-                        temp_32 = htonl(ch->tx_count);
+                        temp_32 = htonl(rt->tx_count);
                         memcpy(&response[offset], &temp_32, 4); offset += 4;
-                        LOG_DEBUG("    - TX Count: %u", ch->tx_count);
+                        LOG_DEBUG("    - TX Count: %u", rt->tx_count);
 
-                        temp_32 = htonl(ch->rx_count);
+                        temp_32 = htonl(rt->rx_count);
                         memcpy(&response[offset], &temp_32, 4); offset += 4;
-                        LOG_DEBUG("    - RX Count: %u", ch->rx_count);
+                        LOG_DEBUG("    - RX Count: %u", rt->rx_count);
                         
                         // 注意: VxWorks可能没有htobe64, 需要手动转换
                          
@@ -1328,6 +1329,67 @@ void handle_monitor_request(int session_index, const unsigned char* frame, int l
             }
             break;
 
+        case 0x04: // 读取 Monitor Buffer (环形缓冲区占用与溢出丢弃统计)
+            {
+                const unsigned char* data = frame + 4;
+                unsigned char port_count = NUM_PORTS;
+                int i;
+
+                LOG_DEBUG("  Action: Read Monitor Buffer.");
+                LOG_DEBUG("  [RECEIVED] Requested Port Count: %d", port_count);
+
+                if (port_count == 0 || port_count > NUM_PORTS) {
+                     LOG_ERROR("ConfigTask: Invalid port count %d for Monitor Buffer.", port_count);
+                     return;
+                }
+
+                unsigned char response[1024];
+                int offset = 0;
+                
+                response[offset++] = 0xA5; response[offset++] = 0xA5;
+                response[offset++] = 0x06; response[offset++] = 0x04;
+                response[offset++] = port_count; // 回复请求的端口数量
+
+                semTake(g_config_mutex, WAIT_FOREVER);
+                for (i = 0; i < port_count; i++) {
+                    unsigned char port_index = data[1 + i]; // 1-based index
+                    if (port_index >= 1 && port_index <= NUM_PORTS) {
+                        int channel_index = port_index - 1;
+                        ChannelState* ch = &g_system_config.channels[channel_index];
+                        ChannelRuntime* rt = &g_system_config.runtime[channel_index];
+                        unsigned int temp_32;
+
+                        LOG_DEBUG("  [SENDING] Port %d Monitor Buffer Data:", port_index);
+
+                        response[offset++] = port_index;
+                        response[offset++] = (unsigned char)ch->overflow_policy;
+                        LOG_DEBUG("    - Overflow Policy: %d", ch->overflow_policy);
+
+                        temp_32 = htonl(rt->rx_drop_count);
+                        memcpy(&response[offset], &temp_32, 4); offset += 4;
+                        LOG_DEBUG("    - RX Dropped: %u", rt->rx_drop_count);
+
+                        temp_32 = htonl(rt->tx_drop_count);
+                        memcpy(&response[offset], &temp_32, 4); offset += 4;
+                        LOG_DEBUG("    - TX Dropped: %u", rt->tx_drop_count);
+
+                        temp_32 = htonl((unsigned int)ring_buffer_num_items(&rt->buffer_uart));
+                        memcpy(&response[offset], &temp_32, 4); offset += 4;
+
+                        temp_32 = htonl((unsigned int)ring_buffer_num_items(&rt->buffer_net));
+                        memcpy(&response[offset], &temp_32, 4); offset += 4;
+                        LOG_DEBUG("    - Buffered: UART->NET %u, NET->UART %u",
+                                  (unsigned int)ring_buffer_num_items(&rt->buffer_uart),
+                                  (unsigned int)ring_buffer_num_items(&rt->buffer_net));
+                    }
+                }
+                semGive(g_config_mutex);
+
+                response[offset++] = 0x5A; response[offset++] = 0x5A;
+                send_response(s_sessions[session_index].fd, response, offset);
+            }
+            break;
+
         default:
             LOG_WARN("ConfigTask: Received unknown Sub_ID 0x%02X for Monitor.", sub_id);
             // 此协议没有ACK，所以未知子命令不回复
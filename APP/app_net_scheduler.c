@@ -10,38 +10,416 @@
  * =====================================================================================
  */
 #include "./inc/app_com.h"
+#include "./inc/app_net_scheduler.h"
+#include "./inc/app_net_packing.h"
+#include "./inc/app_net_con.h"
+#include "./HAL/hal_timer.h"
+#include "./HAL/hal_axi16550.h"
+#include "./HAL/hal_pollset.h"
+#include "./HAL/hal_udp_batch.h"
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <pipeDrv.h>
+#include <tickLib.h>
 
 #ifndef TX_CHUNK_SIZE
 #define TX_CHUNK_SIZE (UART_HW_FIFO_SIZE / 2)
 #endif
 
+/* ------------------ 事件驱动调度 ------------------ */
+#define NET_SCHED_WAKE_PIPE   "/pipe/netSched"
+#define NET_SCHED_WAKE_MSGS   (4)      // 唤醒被合并，管道中通常只有一条消息
+#define NET_SCHED_IDLE_MS     (100)    // 没有事件时的最长等待 (缓冲区调整等需要重试的检查)
+#define NET_SCHED_POLL_MS     (5)      // 轮询方式的固定周期 (原中频任务周期)
+#define NET_LAT_BUCKETS       (20)     // 第 k 桶统计 [2^(k-1), 2^k) us 的延迟，最后一桶包含更大的值
+#define NET_SEND_IOV_MAX      (16)     // 一次 sendmsg() 最多包含的数据段 (每帧最多两段)
+#define NET_BATCH_WINDOW_MS   (100)    // 自适应批量的测量窗口
+#define NET_BATCH_MIN_BYTES   (64)     // 一个时延上限内到达的数据少于此值时不攒批，收到即发送
+#define NET_UDP_MAX_PAYLOAD   (1472)   // UDP 模式单个数据报的最大长度 (以太网 MTU 内不分片)，更长的帧拆为多个数据报
+#define NET_UDP_MAX_PEERS     (256)    // UDP 模式每通道由 udp_destinations[] 地址范围展开的目的地址上限
+#define NET_UDP_DGRAMS        (8)      // UDP 模式一批最多包含的帧数 (每帧再乘以目的地址数)
+#define NET_UDP_IOV           (4)      // 每个数据报最多包含的数据段
+#define NET_RECV_BUDGET       (16 * 1024) // 网络接收每轮默认的总字节数上限 (net_recv_budget_set 可调)
+#define NET_RECV_QUANTUM      (1024)   // 网络接收差额轮询中每个通道每次获得的配额 (字节)
+#define NET_RX_WATER_MS       (2000)   // buffer_net 高水位不超过串口在此时间内能发出的字节数，限制主机到设备方向的积压
+#define NET_RX_WATER_MIN      (4096)   // buffer_net 高水位的下限 (字节，低速串口)
+#define NET_CONN_MAILBOX      (16)     // 每通道待接管的新连接数上限 (2的幂)，覆盖一个通道全部客户端同时重连
+
+// 就绪集合中的标识：数据客户端为 (通道号, 客户端槽位)，唤醒管道单独标识
+#define NET_POLL_TAG(ch, slot)    (((uint32_t)(ch) << 8) | (uint32_t)(slot))
+#define NET_POLL_TAG_CHANNEL(tag) ((int)((tag) >> 8))
+#define NET_POLL_TAG_SLOT(tag)    ((int)((tag) & 0xFF))
+#define NET_POLL_TAG_WAKE         (0xFFFFFFFFu)
+
 /* ------------------ Private Function Prototypes ------------------ */
 static void check_for_new_connections(void);
+static void reject_new_connection(const NewConnectionMsg *msg);
+static void channel_uart_open(int channel_index);
+static void check_buffer_resize(void);
 static void run_net_recv(void);
 static void run_net_send(void);
 static void cleanup_data_connection(int channel_index,int client_index_in_array);
+static void net_sched_wait(void);
+static void net_batch_reset(int channel_index);
+static int recv_udp_datagrams(int channel_index, int fd, int max);
+
+/* ------------------ Internal Data Structures ------------------ */
+// 自适应批量发送 (只用于未配置打包参数的通道)，以 net_send_cfg 为初值
+typedef struct {
+    ring_buffer_size_t batch;       // 待发数据达到此字节数即发送，1 表示收到即发送
+    ULONG interval;                 // 未攒够一批时的最长等待 (tick)，不超过 bound
+    ULONG bound;                    // 附加时延上限 (tick)，由 net_send_cfg.send_interval_ms 换算
+    ULONG deadline;                 // 当前批的发送截止 tick
+    int armed;                      // 当前批已开始计时
+    ULONG window_start;             // 测量窗口起点
+    uint32_t window_rx;             // 窗口起点的 rx_count
+    uint32_t window_blocked;        // 窗口起点各客户端 would_block + partial_sends 之和
+    uint32_t rate;                  // 平滑后的每个 bound 内到达的字节数
+} NetBatchCtl;
+
+// 新连接邮箱: ConnectionManagerTask 为唯一生产者，网络调度任务为唯一消费者
+typedef struct {
+    NewConnectionMsg msgs[NET_CONN_MAILBOX];
+    unsigned int head;              // 自由递增，ConnectionManagerTask 写
+    unsigned int tail;              // 自由递增，网络调度任务写
+} NetConnMailbox;
+
+// 网络接收的每通道服务统计
+typedef struct {
+    uint32_t bytes;                 // 读入的字节数 (含 UDP 按溢出策略丢弃的)
+    uint32_t turns;                 // 获得配额的次数
+    uint32_t deferred;              // 本轮总预算用尽、仍有数据留到下一轮的次数
+    uint32_t paused;                // buffer_net 越过高水位、暂停接收 TCP 数据的次数
+} NetRecvStats;
+
+/* ------------------ Private Variables ------------------ */
+static int s_wake_fd = ERROR;                           // 唤醒管道 (tSerialIO / ConnectionManager 写入)
+static volatile int s_wake_pending;                     // 已写入管道、尚未被本任务读走
+static volatile int s_event_driven = 1;                 // 0: 退回固定周期轮询
+static volatile ring_buffer_size_t s_wake_threshold[NUM_PORTS]; // 只按长度打包时为打包长度，否则为1 (有数据就唤醒)
+static uint8_t s_send_blocked_slots[NUM_PORTS];         // 数据已到期但 socket 发送缓冲区已满的客户端槽位
+static uint8_t s_udp_slots[NUM_PORTS];                  // UDP 模式的 socket 所在槽位 (按数据报收发)
+static volatile uint32_t s_net_paused_mask;             // buffer_net 越过高水位、尚未回到低水位而暂停接收的通道
+static uint32_t s_net_paused_last;                      // 上一次等待前登记的暂停通道 (用于统计暂停次数)
+static ring_buffer_size_t s_net_high_water[NUM_PORTS];  // buffer_net 高水位: 达到后停止从 TCP 客户端读取
+static volatile ring_buffer_size_t s_net_low_water[NUM_PORTS]; // buffer_net 低水位: 回落到此后恢复读取
+static volatile UINT32 s_rx_ready_stamp[NUM_PORTS];     // buffer_uart 由空变为非空时的 sysTimestamp()
+static volatile ULONG s_rx_ready_tick[NUM_PORTS];       // 同一时刻的 tickGet()，用于超过时间戳周期的延迟
+static volatile uint32_t s_rx_stamp_mask;               // 上述时间戳有效、尚未统计的通道
+static uint32_t s_latency_hist[NET_LAT_BUCKETS];        // 串口数据就绪到首次 send() 的延迟直方图
+static UINT32 s_latency_max;
+static uint32_t s_wakeups;                              // 等待返回就绪事件的次数
+static poll_event_t s_poll_events[POLL_SET_MAX_FDS];    // 最近一次等待返回的就绪事件
+static int s_num_events;
+static uint8_t s_client_interest[NUM_PORTS][MAX_CLIENTS_PER_CHANNEL]; // 客户端 fd 在就绪集合中关注的事件
+static NetBatchCtl s_batch[NUM_PORTS];
+static NetConnMailbox s_conn_mailbox[NUM_PORTS];
+static volatile uint32_t s_conn_pending_mask;           // 邮箱中有待接管连接的通道，为0时本轮不检查任何邮箱
+static uint8_t s_recv_ready_slots[NUM_PORTS];           // 本轮报告为可读、尚未读空的客户端槽位
+static int s_recv_deficit[NUM_PORTS];                   // 差额轮询: 通道尚未用完的配额
+static uint32_t s_recv_carry_mask;                      // 上一轮预算用尽时仍有数据的通道 (保留配额)
+static int s_recv_next_ch;                              // 下一轮从此通道开始
+static uint8_t s_recv_next_slot[NUM_PORTS];             // 通道内下一次从此槽位开始
+static volatile int s_recv_budget = NET_RECV_BUDGET;
+static NetRecvStats s_recv_stats[NUM_PORTS];
+static struct sockaddr_in s_udp_peers[NET_UDP_MAX_PEERS]; // 当前发送通道展开后的目的地址 (本任务私有)
+
+/* 毫秒换算为 tick，向上取整且不小于1 */
+static ULONG ms_to_ticks(unsigned int ms)
+{
+    ULONG ticks = ((ULONG)ms * sysClkRateGet() + 999) / 1000;
+    return (ticks > 0) ? ticks : 1;
+}
 
 /**
  * @brief 网络调度任务的主入口函数
- * @details 这是一个中等优先级的任务，以轮询方式处理所有网络相关事件。
+ * @details 每轮依次处理新连接、缓冲区调整、网络接收和网络发送，然后阻塞在就绪集合上
+ * (hal_pollset，fd 只在连接建立/断开时登记/注销)，直到出现以下事件之一：
+ * - 唤醒管道可读：ConnectionManager 分发了新连接，或 tSerialIO 使 buffer_uart 达到打包阈值；
+ * - 某个客户端 socket 可读，或有到期数据的 socket 重新可写；
+ * - 最近一个通道的强制发送时间到期 (没有时最多等待 NET_SCHED_IDLE_MS)。
+ * 唤醒管道创建失败或通过 net_sched_mode_set(0) 切换后，退回固定 5ms 周期的轮询。
  */
 void NetworkSchedulerTask(void) {
-	// 检查并接管来自ConnectionManager的新数据连接
-	check_for_new_connections();
+    poll_set_init();
+    if (pipeDevCreate(NET_SCHED_WAKE_PIPE, NET_SCHED_WAKE_MSGS, 1) != OK
+            || (s_wake_fd = open(NET_SCHED_WAKE_PIPE, O_RDWR, 0)) == ERROR
+            || poll_set_add(s_wake_fd, POLL_SET_IN, NET_POLL_TAG_WAKE) != OK) {
+        LOG_ERROR("NetScheduler: Failed to create wake pipe, falling back to %d ms polling.\n",
+                  NET_SCHED_POLL_MS);
+        s_wake_fd = ERROR;
+        s_event_driven = 0;
+    }
+
+    for (;;) {
+        // 检查并接管来自ConnectionManager的新数据连接
+        check_for_new_connections();
+        // 按新的波特率/工作模式调整环形缓冲区容量
+        check_buffer_resize();
+
+        // 处理上次等待报告为可读的客户端
+        run_net_recv();
+        // 处理所有已到期的数据通道的网络发送
+        run_net_send();
+
+        net_sched_wait();
+    }
+}
+
+/**
+ * @brief 唤醒网络调度任务
+ * @details 只有第一次唤醒写入管道，之后的唤醒在任务读走之前被合并。
+ * 管道写入可在中断上下文中进行。
+ */
+void net_scheduler_wake(void)
+{
+    char c = 0;
+
+    if (s_wake_fd == ERROR) {
+        return;
+    }
+    if (__atomic_exchange_n(&s_wake_pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        write(s_wake_fd, &c, 1);
+    }
+}
+
+/**
+ * @brief 串口接收侧通知 (tSerialIO 或串口中断上下文)
+ * @details buffer_uart 由空变为非空时记录时间戳，并唤醒调度任务以启动强制发送计时；
+ * 填充量越过通道的打包长度时再唤醒一次。两次之间的字节不产生任何唤醒。
+ *
+ * @param fill_before 本次写入之前 buffer_uart 中的字节数。
+ */
+void net_scheduler_notify_rx(int channel_index, ring_buffer_size_t fill_before)
+{
+    ring_buffer_size_t threshold = s_wake_threshold[channel_index];
+
+    if (fill_before == 0) {
+        s_rx_ready_stamp[channel_index] = sysTimestamp();
+        s_rx_ready_tick[channel_index] = tickGet();
+        __atomic_fetch_or(&s_rx_stamp_mask, 1u << channel_index, __ATOMIC_RELEASE);
+        net_scheduler_wake();
+    } else if (fill_before < threshold
+            && ring_buffer_num_items(&g_system_config.runtime[channel_index].buffer_uart) >= threshold) {
+        net_scheduler_wake();
+    }
+}
+
+/**
+ * @brief 串口发送侧通知 (tSerialIO 或串口中断上下文)
+ * @details 暂停接收的通道的 buffer_net 回落到低水位后，唤醒调度任务恢复接收该通道的网络数据。
+ */
+void net_scheduler_notify_tx(int channel_index)
+{
+    uint32_t bit = 1u << channel_index;
+
+    if ((s_net_paused_mask & bit)
+            && ring_buffer_num_items(&g_system_config.runtime[channel_index].buffer_net) <= s_net_low_water[channel_index]) {
+        __atomic_fetch_and(&s_net_paused_mask, ~bit, __ATOMIC_RELAXED);
+        net_scheduler_wake();
+    }
+}
+
+/**
+ * @brief 把新的数据连接交给网络调度任务
+ * @details 每通道一个单生产者/单消费者的无锁邮箱，写入后置位通道的待接管标志并唤醒调度任务。
+ * 只能由 ConnectionManagerTask 调用。
+ *
+ * @return STATUS OK 成功；ERROR 通道号无效或邮箱已满 (调用者负责关闭 fd)。
+ */
+STATUS net_scheduler_handoff(const NewConnectionMsg *msg)
+{
+    NetConnMailbox *mb;
+    unsigned int tail;
+
+    if (msg->channel_index < 0 || msg->channel_index >= NUM_PORTS) {
+        return ERROR;
+    }
+    mb = &s_conn_mailbox[msg->channel_index];
+    tail = __atomic_load_n(&mb->tail, __ATOMIC_ACQUIRE);
+    if (mb->head - tail >= NET_CONN_MAILBOX) {
+        return ERROR;
+    }
+    mb->msgs[mb->head % NET_CONN_MAILBOX] = *msg;
+    __atomic_store_n(&mb->head, mb->head + 1, __ATOMIC_RELEASE);
+    // 先发布消息再置标志，调度任务清标志后总能看到此前写入的消息
+    __atomic_fetch_or(&s_conn_pending_mask, 1u << msg->channel_index, __ATOMIC_RELEASE);
+    net_scheduler_wake();
+    return OK;
+}
 
-	// 处理所有活跃数据通道的网络接收
-	run_net_recv();
-	// 处理所有活跃数据通道的网络发送
-	run_net_send();
+/* 消费者: 取出通道邮箱中最早的一个新连接 */
+static int net_conn_mailbox_pop(int channel_index, NewConnectionMsg *msg)
+{
+    NetConnMailbox *mb = &s_conn_mailbox[channel_index];
+
+    if (__atomic_load_n(&mb->head, __ATOMIC_ACQUIRE) == mb->tail) {
+        return 0;
+    }
+    *msg = mb->msgs[mb->tail % NET_CONN_MAILBOX];
+    __atomic_store_n(&mb->tail, mb->tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* 统计一个通道从串口数据就绪到首次发送的延迟 */
+static void net_latency_record(int i)
+{
+    UINT32 us = hal_timestamp_to_us(hal_timestamp_elapsed(s_rx_ready_stamp[i], sysTimestamp()));
+    ULONG ticks = tickGet() - s_rx_ready_tick[i];
+    UINT32 tick_us = (UINT32)((UINT64)ticks * 1000000 / sysClkRateGet());
+    int k;
+
+    // 时间戳计数器周期较短 (常为一个系统 tick)，超过周期时改用 tick 计时
+    if (ticks > 1 && tick_us > us) {
+        us = tick_us;
+    }
+    k = (us == 0) ? 0 : 32 - __builtin_clz(us);
+    if (k >= NET_LAT_BUCKETS) {
+        k = NET_LAT_BUCKETS - 1;
+    }
+    s_latency_hist[k]++;
+    if (us > s_latency_max) {
+        s_latency_max = us;
+    }
+}
+
+/* 修改一个客户端 fd 关注的事件，只在变化时访问就绪集合 */
+static void client_interest_set(int i, int j, uint32_t events)
+{
+    if (s_client_interest[i][j] == events) {
+        return;
+    }
+    s_client_interest[i][j] = (uint8_t)events;
+    poll_set_modify(g_system_config.channels[i].data_net_info.client_fds[j], events, NET_POLL_TAG(i, j));
+}
+
+/**
+ * @brief 计算通道 buffer_net 的高/低水位
+ * @details 高水位取容量的 3/4 与 NET_RX_WATER_MS 内串口能发出的字节数中较小的一个 (不低于
+ * NET_RX_WATER_MIN)，低水位为高水位的一半。低速串口配有大缓冲区时，积压的数据也只有几秒。
+ */
+static void net_water_update(int i)
+{
+    ring_buffer_size_t cap = RING_BUFFER_CAPACITY(&g_system_config.runtime[i].buffer_net);
+    ring_buffer_size_t high = cap - cap / 4;
+    int baud = g_system_config.channels[i].baudrate;
+
+    if (baud > 0) {
+        // 每字符按 10 位计
+        ring_buffer_size_t line = (ring_buffer_size_t)((UINT64)baud / 10 * NET_RX_WATER_MS / 1000);
+        if (line < NET_RX_WATER_MIN) {
+            line = NET_RX_WATER_MIN;
+        }
+        if (high > line) {
+            high = line;
+        }
+    }
+    s_net_high_water[i] = high;
+    s_net_low_water[i] = high / 2;
 }
 
 /**
- * @brief (非阻塞)检查所有通道的新连接消息队列，并将新的fd分类存放到正确的管理结构中
+ * @brief 阻塞直到下一个网络事件
+ * @details 客户端 fd 默认关注可读。buffer_net 达到高水位的通道暂不关注 TCP 客户端的可读
+ * (否则 socket 一直可读)，数据留在 socket 中由 TCP 接收窗口限制发送方，
+ * 直到 tSerialIO 把 buffer_net 取到低水位；UDP 无法限流，只在 buffer_net 已满时暂停。
+ * 有到期数据但上次未能发完的客户端关注可写。就绪事件保存在 s_poll_events 中。
+ */
+static void net_sched_wait(void)
+{
+    uint32_t ports = g_channel_client_mask;
+    uint32_t was_paused = s_net_paused_mask;
+    uint32_t paused = 0;
+    int timeout_ms = 0;
+    int i, j, k;
+
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        ring_buffer_t* rb = &g_system_config.runtime[i].buffer_net;
+        ring_buffer_size_t used = ring_buffer_num_items(rb);
+        uint32_t tcp_events = POLL_SET_IN;
+        uint32_t udp_events = POLL_SET_IN;
+
+        net_water_update(i);
+        // 达到高水位时暂停，暂停后回落到低水位才恢复
+        if (used >= s_net_high_water[i] || ((was_paused & (1u << i)) && used > s_net_low_water[i])) {
+            if (!(s_net_paused_last & (1u << i))) {
+                s_recv_stats[i].paused++;
+            }
+            paused |= 1u << i;
+            tcp_events = 0;
+            if (ring_buffer_num_free(rb) == 0) {
+                udp_events = 0;
+            }
+        }
+        for (j = 0; j < g_system_config.channels[i].data_net_info.num_clients; j++) {
+            uint32_t events = (s_udp_slots[i] & (1u << j)) ? udp_events : tcp_events;
+            client_interest_set(i, j, events | ((s_send_blocked_slots[i] & (1u << j)) ? POLL_SET_OUT : 0));
+        }
+    }
+    // 先登记再检查一次，避免 tSerialIO 在两者之间取走数据而丢失唤醒
+    __atomic_store_n(&s_net_paused_mask, paused, __ATOMIC_SEQ_CST);
+    s_net_paused_last = paused;
+    ports = paused;
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        if (ring_buffer_num_items(&g_system_config.runtime[i].buffer_net) <= s_net_low_water[i]) {
+            net_scheduler_wake();
+        }
+    }
+
+    if (s_event_driven) {
+        // 超时取最近一个强制发送或批量发送的截止时间
+        ULONG wait_ticks = ms_to_ticks(NET_SCHED_IDLE_MS);
+        ULONG now = tickGet();
+        ULONG deadline;
+        ports = g_channel_client_mask;
+        while (ports) {
+            i = __builtin_ctz(ports);
+            ports &= ports - 1;
+            if (s_batch[i].armed) {
+                deadline = s_batch[i].deadline;
+            } else if (!packer_deadline(i, &deadline)) {
+                continue;
+            }
+            long left = (long)(deadline - now);
+            if (left <= 0) {
+                wait_ticks = 0;
+            } else if ((ULONG)left < wait_ticks) {
+                wait_ticks = left;
+            }
+        }
+        timeout_ms = (int)((wait_ticks * 1000 + sysClkRateGet() - 1) / sysClkRateGet());
+    } else {
+        taskDelay(ms_to_ticks(NET_SCHED_POLL_MS));
+    }
+
+    s_num_events = poll_set_wait(s_poll_events, POLL_SET_MAX_FDS, timeout_ms);
+    if (s_num_events <= 0) {
+        s_num_events = 0;
+        return;
+    }
+    s_wakeups++;
+    for (k = 0; k < s_num_events; k++) {
+        if (s_poll_events[k].tag == NET_POLL_TAG_WAKE) {
+            char c;
+            // 先清标志再读，之后的唤醒会重新写入管道
+            __atomic_store_n(&s_wake_pending, 0, __ATOMIC_SEQ_CST);
+            read(s_wake_fd, &c, 1);
+        }
+    }
+}
+
+/**
+ * @brief (非阻塞)接管所有通道邮箱中的新连接，并将新的fd分类存放到正确的管理结构中
  *
  * @description
- * 此函数被设计为在主调度循环中被频繁调用。它会轮询所有16个通道的消息队列
- * (g_net_conn_q[0] 到 g_net_conn_q[15])。
- * 当接收到一个由 ConnectionManagerTask 分发来的 NewConnectionMsg 时，它会：
+ * 此函数被设计为在主调度循环中被频繁调用。它先取走待接管标志字 s_conn_pending_mask，
+ * 为0时直接返回，不做任何系统调用；否则把置位通道的邮箱全部取空 (一轮即可接管
+ * 网络恢复后同时重连的所有客户端)。
+ * 对每个由 ConnectionManagerTask 交来的 NewConnectionMsg，它会：
  * 1. 根据 msg.channel_index 定位到对应的全局配置 ChannelState。
  * 2. 根据 msg.conn_type 判断连接的类型（如：普通数据、RealCOM数据、RealCOM命令等）。
  * 3. 将新的 client_fd 存入 ChannelState 中对应的 NetInfo 结构体
@@ -51,12 +429,16 @@ void NetworkSchedulerTask(void) {
  */
 static void check_for_new_connections(void) {
     NewConnectionMsg msg;
+    uint32_t ports;
     int i; // 用于遍历通道
-    // 1. 遍历所有通道的消息队列
-    for (i = 0; i < NUM_PORTS; i++) 
+    // 1. 取走待接管标志，之后交来的连接会重新置位，下一轮再处理
+    ports = __atomic_exchange_n(&s_conn_pending_mask, 0, __ATOMIC_ACQ_REL);
+    while (ports)
     {
-        // 使用 while 循环来排空当前通道队列中的所有消息
-        if (msgQReceive(g_net_conn_q[i], (char*) &msg, sizeof(msg), NO_WAIT) == sizeof(NewConnectionMsg))
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        // 使用 while 循环来排空当前通道邮箱中的所有消息
+        while (net_conn_mailbox_pop(i, &msg))
         {
             // 验证消息的合法性
             if (msg.channel_index != i) {
@@ -76,16 +458,63 @@ static void check_for_new_connections(void) {
             {
                 case CONN_TYPE_TCPSERVER:
 				case CONN_TYPE_REALCOM_DATA:
+				case CONN_TYPE_TCPCLIENT:
+					// TCP Client 的每个目标各占一个槽位，有独立的读游标和滞后处理，
+					// 一个目标失联或阻塞不影响其他目标；断开后由 ConnectionManagerTask 按目标重连
+				case CONN_TYPE_UDP:
+					// UDP 模式的 socket 也占一个槽位，由它把每帧发给 udp_destinations[] 的所有地址
+					// 邮箱一轮取空，同时到达的连接可能超过槽位数
+					if (channel->data_net_info.num_clients >= MAX_CLIENTS_PER_CHANNEL) {
+						LOG_ERROR("NetScheduler: Ch %d has no free client slot. Closing fd=%d\n", i, msg.client_fd);
+						reject_new_connection(&msg);
+						continue;
+					}
+					// 第一个数据客户端接入时才从缓冲池分配环形缓冲区
+					if (channel->data_net_info.num_clients == 0 && channel_buffers_attach(i) != OK) {
+						LOG_ERROR("NetScheduler: Ch %d has no ring buffer memory. Closing fd=%d\n", i, msg.client_fd);
+						reject_new_connection(&msg);
+						continue;
+					}
+					// 数据通路直接 recv()/send() 环形缓冲区内存，必须保证 fd 为非阻塞
+					fcntl(msg.client_fd, F_SETFL, fcntl(msg.client_fd, F_GETFL, 0) | O_NONBLOCK);
+					// 字符间隔打包要求每帧单独成段，关闭 Nagle 以免小帧在协议栈中被合并
+					if (channel->packing_settings.char_gap != 0 && msg.type != CONN_TYPE_UDP) {
+						int nodelay = 1;
+						setsockopt(msg.client_fd, IPPROTO_TCP, TCP_NODELAY, (char*)&nodelay, sizeof(nodelay));
+					}
+					// 登记到就绪集合，关注的事件在下次等待前按通道状态修正
+					s_client_interest[i][channel->data_net_info.num_clients] = POLL_SET_IN;
+					if (poll_set_add(msg.client_fd, POLL_SET_IN,
+							NET_POLL_TAG(i, channel->data_net_info.num_clients)) != OK) {
+						LOG_ERROR("NetScheduler: Ch %d failed to register fd=%d. Closing.\n", i, msg.client_fd);
+						if (channel->data_net_info.num_clients == 0) {
+							channel_buffers_detach(i);
+						}
+						reject_new_connection(&msg);
+						continue;
+					}
 					channel->data_net_info.state = NET_STATE_CONNECTED;
 					channel->data_net_info.client_fds[channel->data_net_info.num_clients] = msg.client_fd;
+					// 新客户端从当前未结束帧的起点开始接收，不会收到半个帧
+					channel->data_net_info.read_pos[channel->data_net_info.num_clients] = packer_join_pos(i);
+					memset(&channel->data_net_info.send_stats[channel->data_net_info.num_clients], 0, sizeof(ClientSendStats));
+					channel->data_net_info.dest_index[channel->data_net_info.num_clients] =
+							(msg.type == CONN_TYPE_TCPCLIENT) ? (signed char)msg.dest_index : -1;
+					if (msg.type == CONN_TYPE_UDP) {
+						s_udp_slots[i] |= 1u << channel->data_net_info.num_clients;
+					} else {
+						s_udp_slots[i] &= ~(1u << channel->data_net_info.num_clients);
+					}
 					channel->data_net_info.num_clients++;
+					dev_channel_activity_update(i);
+					// TCP Client 和 UDP 模式没有打开串口的驱动命令，第一个数据连接接管时打开
+					if ((msg.type == CONN_TYPE_TCPCLIENT || msg.type == CONN_TYPE_UDP)
+							&& channel->uart_state != UART_STATE_OPENED) {
+						channel_uart_open(i);
+					}
 				break;
 
-                case CONN_TYPE_TCPCLIENT:
-				case CONN_TYPE_UDP:
 
-				break;
-                
                 default:
                     LOG_ERROR("NetScheduler: Ch %d received unknown conn_type %d. Closing fd=%d\n",
                               i, msg.type, msg.client_fd);
@@ -102,178 +531,824 @@ static void check_for_new_connections(void) {
     // (处理全局配置连接队列 g_config_conn_q 的逻辑可以放在这里，如果需要的话)
 }
 
+/**
+ * @brief 从缓冲池为通道分配两个方向的环形缓冲区
+ * @details 容量取 ring_size；缓冲池紧张时逐级减半，直至最小块。
+ * 调用时串口收发周期不得访问该通道的环形缓冲区 (无数据客户端，或串口已关闭并经 serial_io_quiesce() 等待)。
+ * @return OK 成功；ERROR 缓冲池已耗尽
+ */
+STATUS channel_buffers_attach(int channel_index)
+{
+    ChannelState* channel = &g_system_config.channels[channel_index];
+    ChannelRuntime* rt = &g_system_config.runtime[channel_index];
+    size_t size = channel->ring_size ? channel->ring_size : BUF_POOL_MIN_BLOCK;
+    char *net_mem;
+    char *uart_mem;
+    int j;
+
+    for (;;) {
+        net_mem = (char*)buf_pool_alloc(size);
+        uart_mem = (char*)buf_pool_alloc(size);
+        if (net_mem != NULL && uart_mem != NULL) {
+            break;
+        }
+        buf_pool_free(net_mem);
+        buf_pool_free(uart_mem);
+        if (size <= BUF_POOL_MIN_BLOCK) {
+            return ERROR;
+        }
+        size >>= 1;
+    }
+
+    if (size != channel->ring_size) {
+        LOG_WARN("NetScheduler: Ch %d ring buffer reduced to %u bytes (wanted %u), pool free %u.\n",
+                 channel_index, (unsigned int)size, channel->ring_size, (unsigned int)buf_pool_free_bytes());
+    }
+
+    ring_buffer_init(&rt->buffer_net,  net_mem,  size);
+    ring_buffer_init(&rt->buffer_uart, uart_mem, size);
+    packer_reset(channel_index, 0);
+    net_batch_reset(channel_index);
+    for (j = 0; j < MAX_CLIENTS_PER_CHANNEL; j++) {
+        channel->data_net_info.read_pos[j] = 0;
+    }
+    channel->ring_resize_pending = 0;
+    return OK;
+}
+
+/**
+ * @brief 将通道的环形缓冲区存储区归还缓冲池
+ * @details 调用条件同 channel_buffers_attach()。
+ */
+void channel_buffers_detach(int channel_index)
+{
+    ChannelRuntime* rt = &g_system_config.runtime[channel_index];
+
+    buf_pool_free(rt->buffer_net.buffer);
+    buf_pool_free(rt->buffer_uart.buffer);
+    memset(&rt->buffer_net,  0, sizeof(ring_buffer_t));
+    memset(&rt->buffer_uart, 0, sizeof(ring_buffer_t));
+}
+
+/**
+ * @brief 波特率或工作模式变化后，按新的 ring_size 重新分配环形缓冲区
+ * @details 只在两个方向都为空时进行 (通常是 Real COM 打开串口时)，否则下个周期再试。
+ * 期间暂时关闭串口状态并等待进行中的收发周期结束，tSerialIO 不会访问本通道的环形缓冲区。
+ */
+static void check_buffer_resize(void)
+{
+    uint32_t ports = g_channel_client_mask;
+    int i;
+
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        ChannelState* channel = &g_system_config.channels[i];
+        ChannelRuntime* rt = &g_system_config.runtime[i];
+
+        if (!channel->ring_resize_pending) {
+            continue;
+        }
+        if (RING_BUFFER_CAPACITY(&rt->buffer_uart) == channel->ring_size) {
+            channel->ring_resize_pending = 0;
+            continue;
+        }
+        if (!ring_buffer_is_empty(&rt->buffer_uart) || !ring_buffer_is_empty(&rt->buffer_net)) {
+            continue;
+        }
+
+        UartPhysicalState saved_state = channel->uart_state;
+        channel->uart_state = UART_STATE_CLOSED;
+        dev_channel_activity_update(i);
+        serial_io_quiesce();
+
+        // 缓冲池紧张时 attach 逐级减半 (增大时包含原容量)，旧存储区刚归还，
+        // 只有缓冲池同时被其他通道的分配占满才会失败
+        channel_buffers_detach(i);
+        if (channel_buffers_attach(i) != OK) {
+            // 没有环形缓冲区不能继续收发: 串口保持关闭，ring_resize_pending 保持置位，
+            // 断开本通道的客户端，下一个客户端接入时重新分配
+            LOG_ERROR("NetScheduler: Ch %d ring buffer resize to %u bytes failed, pool free %u. Closing its clients.\n",
+                      i, channel->ring_size, (unsigned int)buf_pool_free_bytes());
+            while (channel->data_net_info.num_clients > 0) {
+                cleanup_data_connection(i, channel->data_net_info.num_clients - 1);
+            }
+            continue;
+        }
+        // 新缓冲区从0开始，各客户端游标已由 attach 复位，ring_resize_pending 已清除
+
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        channel->uart_state = saved_state;
+        dev_channel_activity_update(i);
+        LOG_INFO("NetScheduler: Ch %d ring buffers resized to %u bytes.\n",
+                 i, (unsigned int)RING_BUFFER_CAPACITY(&rt->buffer_uart));
+    }
+}
+
 /*
  * =====================================================================================
  *
- * 顾问修改说明:
- *
- * 原有 `run_net_recv` 的问题:
- * 1. 在 `run_net_recv` 中，`recv()` 是在一个循环中被无条件调用的。
- * 2. 如果 `client_fd` 是阻塞模式 (默认)，`recv()` 会阻塞整个实时任务，导致
- * 上游的 `handle_serial_rx` 无法执行，引发UART FIFO溢出和数据丢失。
- *
- * 修改方案:
- * 1. **依赖非阻塞Socket**: 我们依赖上一步在 `app_net_con.c` 中所做的修改，
- * 即所有 `accept()` 的 `fd` 都已被设为 `O_NONBLOCK`。
- * 2. **引入 `select()` 检测可读性**:
- * - 在 `recv()` 之前，我们构建一个包含所有客户端 `fd` 的 `readfds` 集合。
- * - 使用 `select()` (超时设为0) 立即返回哪些 `fd` 真正有数据可读。
- * 3. **按需 `recv()`**:
- * - 只有 `FD_ISSET(fd, &readfds)` 为真的 `fd`，我们才对其调用 `recv()`。
- *
- * 优点:
- * - **杜绝阻塞**: 彻底解决了 `recv()` 阻塞实时任务的风险。
- * - **极高效率**: `select()` 是一次系统调用，远快于循环中 N 次无效的 `recv()`
- * (并检查 EWOULDBLOCK)。CPU只处理真正有数据的socket。
- * - **代码一致性**: 此逻辑与我们修改后的 `run_net_send` 保持一致。
+ * 网络数据接收:
+ * 1. 数据 socket 在接管时设为非阻塞 (O_NONBLOCK)，recv() 不会阻塞本任务。
+ * 2. `net_sched_wait()` 等待持久的就绪集合 `hal_pollset`，socket 只在连接建立/关闭时登记/注销，
+ *    事件直接给出通道号和客户端槽位，只对报告为可读的客户端调用 recv()。
+ * 3. `run_net_recv()` 按差额轮询在各通道间分配每轮的字节预算，TCP 数据只读到 buffer_net 的高水位，
+ *    其余留在 socket 中由 TCP 接收窗口让发送方等待。
  *
  * =====================================================================================
  */
 #define TX_NET_SIZE (4096) 
-unsigned char temp_buffer_net_rx[TX_NET_SIZE];
-static void run_net_recv(void) {
 
-    int i, j;
-    fd_set readfds; // 用于 select 的可读文件描述符集合
-    int max_fd = 0;
-    struct timeval timeout = {0, 0}; // 完全非阻塞的 select
+// UDP 数据报的接收中转区
+static unsigned char s_net_overflow_buf[TX_NET_SIZE];
 
-    FD_ZERO(&readfds);
+/**
+ * @brief 从一个客户端读取最多 max 字节到 buffer_net
+ * @details 直接 recv() 到环形缓冲区的空闲区域，空闲区域最多分为两段 (回绕前/回绕后)
+ * (本任务为 buffer_net 的唯一生产者)。TCP 数据只读到高水位为止，不按溢出策略丢弃：
+ * 其余数据留在 socket 中，由 TCP 接收窗口让发送方等待。对端关闭或出错时清理该客户端。
+ *
+ * @param more 输出: 1 表示读满了 max，socket 中可能还有数据。
+ * @return int 读取的字节数。
+ */
+static int net_recv_client(int i, int j, int max, int *more)
+{
+    ChannelState* channel = &g_system_config.channels[i];
+    ChannelRuntime* rt = &g_system_config.runtime[i];
+    int fd = channel->data_net_info.client_fds[j];
+    ring_buffer_size_t used;
+    int total = 0;
 
-    // 1. 构建 fd_set，包含所有通道的所有活动客户端
-    for (i = 0; i < NUM_PORTS; i++) {
+    *more = 0;
+    if (s_udp_slots[i] & (1u << j)) {
+        total = recv_udp_datagrams(i, fd, max);
+        *more = (total >= max);
+        return total;
+    }
+
+    used = ring_buffer_num_items(&rt->buffer_net);
+    if (used >= s_net_high_water[i]) {
+        __atomic_fetch_or(&s_net_paused_mask, 1u << i, __ATOMIC_RELAXED);
+        return 0; // 已达到高水位，数据暂留在socket中
+    }
+    if ((ring_buffer_size_t)max > s_net_high_water[i] - used) {
+        max = (int)(s_net_high_water[i] - used);
+    }
+
+    while (total < max) {
+        char *span;
+        ring_buffer_size_t span_len = ring_buffer_reserve(&rt->buffer_net, &span);
+        if (span_len == 0) {
+            return total;
+        }
+        if (span_len > (ring_buffer_size_t)(max - total)) {
+            span_len = max - total;
+        }
+
+        // (由于就绪集合报告了可读性且 fd 为非阻塞，此处的 recv() 不会阻塞)
+        int n = recv(fd, span, span_len, 0);
+
+        if (n > 0) {
+            // 成功读取数据
+            rt->tx_net += n;
+            total += n;
+            ring_buffer_commit(&rt->buffer_net, n);
+            if ((ring_buffer_size_t)n < span_len) {
+                return total; // socket 已读空
+            }
+        } else if (n == 0) {
+            // 客户端主动关闭 (TCP FIN)
+            cleanup_data_connection(i, j);
+            return total;
+        } else {
+            // n < 0
+            // 理论上，因为 fd 已报告为可读，不应再收到 EWOULDBLOCK。
+            // 但为健壮性，我们仍然检查：忽略 EWOULDBLOCK，其他视为错误。
+            if (errno != EWOULDBLOCK && errno != EAGAIN) {
+                // 发生真实错误 (如 RST)
+                cleanup_data_connection(i, j);
+            }
+            return total;
+        }
+    }
+    // 读到高水位时进入暂停状态 (直到回落到低水位)，该客户端退出本轮
+    if (used + total >= s_net_high_water[i]) {
+        __atomic_fetch_or(&s_net_paused_mask, 1u << i, __ATOMIC_RELAXED);
+        return total;
+    }
+    *more = (total >= max);
+    return total;
+}
+
+/**
+ * @brief 按差额轮询 (DRR) 从可读的客户端接收数据
+ * @details 每轮总共最多读取 s_recv_budget 字节。有可读客户端的通道依次获得 NET_RECV_QUANTUM
+ * 字节的配额，通道内的可读客户端轮流使用该配额；读空的通道退出本轮并清零配额。
+ * 预算用尽时记下停在的通道和各通道的槽位，下一轮从那里继续 (未用完的配额保留)，
+ * 一个通道的大量数据最多让其他通道等待一次配额，不会推迟其他通道的接收。
+ */
+static void run_net_recv(void) {
+
+    uint32_t active = 0;
+    uint32_t ports;
+    int budget = s_recv_budget;
+    int i, j, k;
+
+    // 1. 仅对就绪集合报告为可读的 fd 执行 recv()，事件标识直接给出通道号和客户端槽位
+    for (k = 0; k < s_num_events; k++) {
+        poll_event_t* ev = &s_poll_events[k];
+        if (ev->tag == NET_POLL_TAG_WAKE || !(ev->events & POLL_SET_IN)) {
+            continue;
+        }
+        i = NET_POLL_TAG_CHANNEL(ev->tag);
+        j = NET_POLL_TAG_SLOT(ev->tag);
         ChannelState* channel = &g_system_config.channels[i];
-        for (j = channel->data_net_info.num_clients - 1; j >= 0; j--) {
-            int fd = channel->data_net_info.client_fds[j];
-            if (fd >= 0) {
-                FD_SET(fd, &readfds);
-                if (fd > max_fd) {
-                    max_fd = fd;
-                }
+
+        // 本轮已有客户端断开时，槽位可能已被移动或回收
+        if (j >= channel->data_net_info.num_clients || channel->data_net_info.client_fds[j] != ev->fd) {
+            continue;
+        }
+        s_recv_ready_slots[i] |= 1u << j;
+        active |= 1u << i;
+    }
+    s_num_events = 0;
+
+    // 上一轮留下的配额只对仍有数据的通道有效
+    ports = s_recv_carry_mask & ~active;
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        s_recv_deficit[i] = 0;
+    }
+
+    // 2. 差额轮询，从上一轮停下的通道开始
+    i = s_recv_next_ch;
+    while (active && budget > 0) {
+        if (!(active & (1u << i))) {
+            i = (i + 1) % NUM_PORTS;
+            continue;
+        }
+        if (s_recv_deficit[i] <= 0) {
+            s_recv_deficit[i] += NET_RECV_QUANTUM;
+            s_recv_stats[i].turns++;
+        }
+
+        while (s_recv_ready_slots[i] && s_recv_deficit[i] > 0 && budget > 0) {
+            uint32_t slots = s_recv_ready_slots[i];
+            uint32_t after = slots >> s_recv_next_slot[i];
+            int max = (s_recv_deficit[i] < budget) ? s_recv_deficit[i] : budget;
+            int more, n, fd;
+
+            // 通道内从上次停下的槽位开始轮流
+            j = after ? (s_recv_next_slot[i] + __builtin_ctz(after)) : __builtin_ctz(slots);
+            fd = g_system_config.channels[i].data_net_info.client_fds[j];
+            n = net_recv_client(i, j, max, &more);
+            s_recv_deficit[i] -= n;
+            budget -= n;
+            s_recv_stats[i].bytes += n;
+            s_recv_next_slot[i] = (uint8_t)(j + 1);
+            // 客户端已被清理时其槽位的标志已由 cleanup_data_connection() 处理
+            if (!more && j < g_system_config.channels[i].data_net_info.num_clients
+                    && g_system_config.channels[i].data_net_info.client_fds[j] == fd) {
+                s_recv_ready_slots[i] &= ~(1u << j);
             }
         }
+
+        if (!s_recv_ready_slots[i]) {
+            active &= ~(1u << i);
+            s_recv_deficit[i] = 0; // 读空的通道不积累配额
+            i = (i + 1) % NUM_PORTS;
+        } else if (s_recv_deficit[i] <= 0) {
+            i = (i + 1) % NUM_PORTS; // 配额用完，轮到下一个通道
+        }
     }
 
-    if (max_fd == 0) {
-        return; // 没有任何活动的客户端，直接返回
+    // 3. 预算用尽时仍有数据的通道下一轮由就绪集合再次报告
+    s_recv_next_ch = i;
+    s_recv_carry_mask = active;
+    ports = active;
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        s_recv_stats[i].deferred++;
+        s_recv_ready_slots[i] = 0;
     }
+}
+
 
-    // 2. 非阻塞地轮询哪些 fd 准备好了
-    int ret = select(max_fd + 1, &readfds, NULL, NULL, &timeout);
 
-    if (ret <= 0) {
-        return; // 没有任何 fd 可读 (ret=0) 或 select 发生错误 (ret<0)
+/* 单批上限：一轮发送预算，且不超过环形缓冲区的一半 */
+static ring_buffer_size_t net_batch_max(int channel_index)
+{
+    ring_buffer_size_t half = RING_BUFFER_CAPACITY(&g_system_config.runtime[channel_index].buffer_uart) / 2;
+    return (half < TX_NET_SIZE) ? half : TX_NET_SIZE;
+}
+
+/* 各客户端发送受阻 (EWOULDBLOCK 或部分发送) 的累计次数 */
+static uint32_t net_batch_blocked(const DataChannelInfo *info)
+{
+    uint32_t sum = 0;
+    int j;
+
+    for (j = 0; j < info->num_clients; j++) {
+        sum += info->send_stats[j].would_block + info->send_stats[j].partial_sends;
     }
+    return sum;
+}
 
-    // 3. 仅对 select() 报告为可读的 fd 执行 recv()
-    for (i = 0; i < NUM_PORTS; i++) {
-        ChannelState* channel = &g_system_config.channels[i];
-        for (j = channel->data_net_info.num_clients - 1; j >= 0; j--) {
-            int fd = channel->data_net_info.client_fds[j];
-            
-            // 检查这个 fd 是否在可读集合中
-            if (fd >= 0 && FD_ISSET(fd, &readfds)) {
-                
-                // (由于 select() 保证了可读性，此处的 recv() 不会阻塞)
-                int n = recv(fd, (char*) temp_buffer_net_rx, sizeof(temp_buffer_net_rx), 0);
-
-                if (n > 0) {
-                    // 成功读取数据
-                    ring_buffer_queue_arr(&channel->buffer_net, (char*) temp_buffer_net_rx, n);
-                    channel->tx_net += n;
-                } else if (n == 0) {
-                    // 客户端主动关闭 (TCP FIN)
-                    cleanup_data_connection(i, j);
-                } else {
-                    // n < 0
-                    // 理论上，因为我们用了 select()，不应再收到 EWOULDBLOCK。
-                    // 但为健壮性，我们仍然检查：忽略 EWOULDBLOCK，其他视为错误。
-                    if (errno != EWOULDBLOCK && errno != EAGAIN) {
-                        // 发生真实错误 (如 RST)
-                        cleanup_data_connection(i, j);
-                    }
-                }
+/* 通道接入第一个客户端时复位，以按波特率算出的 net_send_cfg 为初值 */
+static void net_batch_reset(int channel_index)
+{
+    ChannelState* channel = &g_system_config.channels[channel_index];
+    NetBatchCtl* b = &s_batch[channel_index];
+    ring_buffer_size_t max = net_batch_max(channel_index);
+    int size = channel->net_send_cfg.packet_size;
+
+    memset(b, 0, sizeof(NetBatchCtl));
+    b->bound = ms_to_ticks((channel->net_send_cfg.send_interval_ms > 0) ? channel->net_send_cfg.send_interval_ms : 1);
+    b->interval = b->bound;
+    b->batch = (size <= 0) ? 1 : (((ring_buffer_size_t)size > max) ? max : (ring_buffer_size_t)size);
+    b->rate = b->batch * 2;
+    b->window_start = tickGet();
+    b->window_rx = g_system_config.runtime[channel_index].rx_count;
+    b->window_blocked = net_batch_blocked(&channel->data_net_info);
+}
+
+/**
+ * @brief 每个测量窗口按到达速率和 socket 排空情况调整批量与等待时间
+ * @details
+ * - 一个时延上限内到达的数据不足 NET_BATCH_MIN_BYTES 时为低速，攒批只增加时延，收到即发送；
+ * - 否则批量取一个时延上限内到达量的一半，稳定速率下按大小触发发送，速率下降时由截止时间兜底；
+ * - 窗口内出现 EWOULDBLOCK 或部分发送时 socket 排空慢于到达，批量取上限，以最少的调用搬运积压；
+ * 等待时间取攒够一批所需时间的两倍，且不超过时延上限。
+ */
+static void net_batch_update(int channel_index, ULONG now)
+{
+    NetBatchCtl* b = &s_batch[channel_index];
+    ULONG elapsed = now - b->window_start;
+    uint32_t rx, blocked, sample;
+    ring_buffer_size_t max;
+
+    if (elapsed < ms_to_ticks(NET_BATCH_WINDOW_MS)) {
+        return;
+    }
+    rx = g_system_config.runtime[channel_index].rx_count;
+    blocked = net_batch_blocked(&g_system_config.channels[channel_index].data_net_info);
+    max = net_batch_max(channel_index);
+
+    sample = (uint32_t)((UINT64)(rx - b->window_rx) * b->bound / elapsed);
+    b->rate = (b->rate * 3 + sample) / 4;
+
+    // 客户端断开时计数随槽位移走，只把增加视为受阻
+    if ((int32_t)(blocked - b->window_blocked) > 0) {
+        b->batch = max;
+    } else if (b->rate < NET_BATCH_MIN_BYTES) {
+        b->batch = 1;
+    } else {
+        b->batch = (b->rate / 2 < max) ? (ring_buffer_size_t)(b->rate / 2) : max;
+    }
+
+    if (b->batch <= 1 || b->rate == 0) {
+        b->interval = b->bound;
+    } else {
+        ULONG fill = (ULONG)((UINT64)b->batch * b->bound / b->rate);
+        b->interval = (2 * fill < 1) ? 1 : ((2 * fill > b->bound) ? b->bound : 2 * fill);
+    }
+
+    b->window_start = now;
+    b->window_rx = rx;
+    b->window_blocked = blocked;
+}
+
+/* 判断待发数据是否应当发出：攒够一批，或第一个未发字节已等待 interval */
+static int net_batch_due(int channel_index, ring_buffer_size_t pending, ULONG now)
+{
+    NetBatchCtl* b = &s_batch[channel_index];
+
+    if (pending >= b->batch) {
+        b->armed = 0;
+        return 1;
+    }
+    if (!b->armed) {
+        b->armed = 1;
+        b->deadline = now + b->interval;
+        return 0;
+    }
+    if ((long)(now - b->deadline) >= 0) {
+        b->armed = 0;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 用一次 sendmsg() 发送客户端游标之后的已结束帧
+ * @details iovec 由打包器直接指向环形缓冲区 (每帧跨越回绕点时分两段，被剥离的分隔符不在其中)，
+ * 不做线性化拷贝。同一区域可依次发给多个客户端，各自只推进自己的游标。
+ *
+ * @param max 本次最多发送的字节数。
+ * @param want 输出本次尝试发送的字节数。
+ * @return int sendmsg() 的返回值 (实际接受的字节数或 ERROR)，没有可发送的数据时为0。
+ */
+static int send_ready_frames(int channel_index, int fd, ring_buffer_size_t pos, ring_buffer_size_t max,
+                             ring_buffer_size_t *want)
+{
+    struct iovec iov[NET_SEND_IOV_MAX];
+    struct msghdr msg;
+    int cnt = packer_iov(channel_index, pos, max, iov, NET_SEND_IOV_MAX, want);
+
+    if (cnt == 0) {
+        return 0;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = cnt;
+    return sendmsg(fd, &msg, 0);
+}
+
+/* UDP 模式: 按 udp_destinations[] 展开目的地址 (begin_ip..end_ip，主机字节序，end_ip 为0时只有 begin_ip) */
+static int udp_peers_build(const ChannelState *channel)
+{
+    int n = 0;
+    int d;
+
+    for (d = 0; d < 4; d++) {
+        const UDP_Mode_Settings *dest = &channel->udp_destinations[d];
+        unsigned int ip = dest->begin_ip;
+        unsigned int end = (dest->end_ip >= dest->begin_ip) ? dest->end_ip : dest->begin_ip;
+
+        if (dest->begin_ip == 0 || dest->port == 0) {
+            continue;
+        }
+        for (;;) {
+            if (n == NET_UDP_MAX_PEERS) {
+                return n;
             }
+            memset(&s_udp_peers[n], 0, sizeof(struct sockaddr_in));
+            s_udp_peers[n].sin_family = AF_INET;
+            s_udp_peers[n].sin_port = htons(dest->port);
+            s_udp_peers[n].sin_addr.s_addr = htonl(ip);
+            n++;
+            if (ip == end) {
+                break;
+            }
+            ip++;
+        }
+    }
+    return n;
+}
+
+/* UDP 模式: 来源地址 (主机字节序) 是否在某个目的地址范围内 */
+static int udp_peer_allowed(const ChannelState *channel, unsigned int ip)
+{
+    int d;
+
+    for (d = 0; d < 4; d++) {
+        const UDP_Mode_Settings *dest = &channel->udp_destinations[d];
+        unsigned int end = (dest->end_ip >= dest->begin_ip) ? dest->end_ip : dest->begin_ip;
+
+        if (dest->begin_ip != 0 && ip >= dest->begin_ip && ip <= end) {
+            return 1;
         }
     }
+    return 0;
 }
 
+/**
+ * @brief UDP 模式: 接收最多 max 字节的数据报写入 buffer_net
+ * @details 只接受来源在 udp_destinations[] 地址范围内的数据报，其他的丢弃并计入 udp_reject_count。
+ * 数据报先收到中转区再整体写入，空间不足的部分按溢出策略处理。
+ * 接收错误 (如对端的 ICMP 端口不可达) 不影响 socket 继续使用。
+ *
+ * @return int 取出的字节数 (被拒绝的数据报也计入，0 长度的数据报按1字节计)。
+ */
+static int recv_udp_datagrams(int channel_index, int fd, int max)
+{
+    ChannelState* channel = &g_system_config.channels[channel_index];
+    ChannelRuntime* rt = &g_system_config.runtime[channel_index];
+    int budget = max;
+
+    while (budget > 0) {
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        int n;
 
+        if (channel->overflow_policy == OVERFLOW_POLICY_BLOCK && ring_buffer_num_free(&rt->buffer_net) == 0) {
+            break; // 缓冲区已满，数据报暂留在socket中
+        }
+        n = recvfrom(fd, (char*)s_net_overflow_buf, sizeof(s_net_overflow_buf), 0,
+                     (struct sockaddr*)&from, &from_len);
+        if (n < 0) {
+            break;
+        }
+        budget -= (n > 0) ? n : 1;
+        if (!udp_peer_allowed(channel, ntohl(from.sin_addr.s_addr))) {
+            channel->udp_reject_count++;
+            continue;
+        }
+        rt->tx_net += n;
+        if (channel->overflow_policy == OVERFLOW_POLICY_OVERWRITE_OLDEST) {
+            rt->tx_drop_count += ring_buffer_spsc_overwrite_arr(&rt->buffer_net, (char*)s_net_overflow_buf, n);
+        } else {
+            rt->tx_drop_count += n - ring_buffer_spsc_queue_arr(&rt->buffer_net, (char*)s_net_overflow_buf, n);
+        }
+    }
+    return max - budget;
+}
+
+/**
+ * @brief UDP 模式: 把游标之后的已结束帧作为数据报发给所有目的地址
+ * @details 每帧 (直通时为一批数据) 是一个数据报，超过 NET_UDP_MAX_PAYLOAD 时拆分，
+ * 依次发给各地址范围内的每个地址。若干帧 x 全部地址的数据报按 UDP_BATCH_MAX 一组交给
+ * udp_send_batch() (主机上为 sendmmsg())。个别地址出错 (如主机不可达) 只计数并跳过。
+ * socket 发送缓冲区满时停止：还没有发给任何地址的帧留到下次，已发给部分地址的帧
+ * 不再补发给其余地址。
+ *
+ * @return ring_buffer_size_t 推进后的游标。
+ */
+static ring_buffer_size_t send_udp_frames(int channel_index, int fd, ring_buffer_size_t pos,
+                                          ring_buffer_size_t ready, ClientSendStats *stats, int *sent_any)
+{
+    static struct iovec iov[NET_UDP_DGRAMS][NET_UDP_IOV];
+    static int iov_cnt[NET_UDP_DGRAMS];
+    static ring_buffer_size_t end_pos[NET_UDP_DGRAMS];
+    static udp_batch_msg_t msgs[UDP_BATCH_MAX];
+    int npeers = udp_peers_build(&g_system_config.channels[channel_index]);
+    ring_buffer_size_t budget = TX_NET_SIZE;
+    int blocked = 0;
+
+    // 没有目的地址时数据无处可发，直接越过
+    if (npeers == 0) {
+        return ready;
+    }
+
+    while (!blocked && pos != ready && budget > 0) {
+        ring_buffer_size_t p = pos;
+        int nd = 0, total, m, k;
+
+        // 1. 取若干帧，每帧的数据段直接指向环形缓冲区
+        while (nd < NET_UDP_DGRAMS && p != ready && budget > 0) {
+            ring_buffer_size_t len;
+
+            iov_cnt[nd] = packer_iov(channel_index, p, NET_UDP_MAX_PAYLOAD, iov[nd], NET_UDP_IOV, &len);
+            if (iov_cnt[nd] == 0) {
+                break;
+            }
+            p = packer_advance(channel_index, p, len);
+            end_pos[nd] = p;
+            budget -= (len < budget) ? len : budget;
+            nd++;
+        }
+        if (nd == 0) {
+            return packer_advance(channel_index, pos, 0); // 只剩被完全剥离的空帧
+        }
+
+        // 2. 第 m 个数据报为第 m / npeers 帧发给第 m % npeers 个地址
+        total = nd * npeers;
+        for (m = 0; m < total; ) {
+            int cnt = (total - m < UDP_BATCH_MAX) ? (total - m) : UDP_BATCH_MAX;
+            int n;
+
+            for (k = 0; k < cnt; k++) {
+                udp_batch_msg_t *msg = &msgs[k];
+                int d = (m + k) / npeers;
+
+                memset(msg, 0, sizeof(udp_batch_msg_t));
+                msg->msg_hdr.msg_name = &s_udp_peers[(m + k) % npeers];
+                msg->msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+                msg->msg_hdr.msg_iov = iov[d];
+                msg->msg_hdr.msg_iovlen = iov_cnt[d];
+            }
+            n = udp_send_batch(fd, msgs, cnt);
+            if (n == ERROR) {
+                if (errno == EWOULDBLOCK || errno == EAGAIN) {
+                    stats->would_block++;
+                    blocked = 1;
+                    break;
+                }
+                stats->send_errors++; // 只影响这一个地址
+                m++;
+                continue;
+            }
+            for (k = 0; k < n; k++) {
+                stats->sent_bytes += msgs[k].msg_len;
+            }
+            *sent_any = 1;
+            m += n;
+        }
+
+        // 3. 至少发给了一个地址的帧都已越过
+        nd = blocked ? (m + npeers - 1) / npeers : nd;
+        if (nd > 0) {
+            pos = end_pos[nd - 1];
+        }
+    }
+    return pos;
+}
 
-unsigned char temp_buffer_net_tx[TX_NET_SIZE]; // 使用更小的块大小
 /**
  * @brief 对所有活跃的数据通道执行非阻塞send
- * @details 从“串口到网络”的环形缓冲区读取数据，并发送给所有连接的客户端。
+ * @details 串口数据先由打包器 (app_net_packing) 按 DataPackingSettings 划分为帧，只有已结束的帧才发送。
+ * 每个客户端在“串口到网络”环形缓冲区中有独立的读游标 (DataChannelInfo.read_pos)，
+ * 只按 sendmsg() 实际发出的字节数推进。暂不可写或部分发送的客户端下次从自己的游标继续，
+ * 不会丢数据；环形缓冲区只释放到最慢客户端的游标为止。
+ * 积压超过 client_lag_limit_pct 的客户端按 client_lag_action 被跳过积压数据或断开，
+ * 避免一个慢客户端拖住整个通道。
  */
 static void run_net_send(void) {
 
     int i, j;
-    fd_set writefds;
-    int max_fd = 0;
-    struct timeval timeout = {0, 0}; // 完全非阻塞的 select
+    uint32_t ports = g_channel_client_mask;
+    ULONG now = tickGet();
 
-    for (i = 0; i < NUM_PORTS; i++) {
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
         ChannelState* channel = &g_system_config.channels[i];
+        ChannelRuntime* rt = &g_system_config.runtime[i];
+        DataChannelInfo* info = &channel->data_net_info;
+        ring_buffer_t* rb = &rt->buffer_uart;
 
-        // 如果该通道没有客户端连接，或者缓冲区没数据，则跳过
-        if (channel->data_net_info.num_clients == 0 || ring_buffer_is_empty(&channel->buffer_uart)) {
+        // 如果该通道没有客户端连接则跳过
+        if (info->num_clients == 0) {
+            s_send_blocked_slots[i] = 0;
             continue;
         }
 
-        FD_ZERO(&writefds);
-        max_fd = 0;
+        // 打包参数属于配置数据，每轮刷新一次供 tSerialIO 判断唤醒：
+        // 未配置打包时攒够一批再唤醒，只按长度打包时攒够一帧再唤醒，
+        // 有分隔符、强制发送时间或字符间隔时需要看到每一批数据
+        int passthrough = packer_is_passthrough(&channel->packing_settings);
+        ring_buffer_size_t threshold = channel->packing_settings.packing_length;
+        if (passthrough) {
+            net_batch_update(i, now);
+            threshold = s_batch[i].batch;
+        } else if (channel->packing_settings.delimiter1 != 0 || channel->packing_settings.force_transmit_time_ms != 0
+                || channel->packing_settings.char_gap != 0) {
+            threshold = 1;
+        } else if (threshold > RING_BUFFER_CAPACITY(rb) / 2) {
+            threshold = RING_BUFFER_CAPACITY(rb) / 2;
+        }
+        s_wake_threshold[i] = threshold;
+        s_send_blocked_slots[i] = 0;
 
-        // 1. 将该通道所有客户端的fd加入select的写集合
-        for (j = 0; j < channel->data_net_info.num_clients; j++) {
-            int fd = channel->data_net_info.client_fds[j];
-            if (fd >= 0) {
-                FD_SET(fd, &writefds);
-                if (fd > max_fd) {
-                    max_fd = fd;
+        // 1. 成帧，只有已结束的帧可以发送 (本任务为 buffer_uart 的唯一消费者)
+        // 缓冲区为空时也要调用，使打包器及时取得新的配置 (如字符间隔)
+        ring_buffer_size_t ready = packer_update(i, now);
+        if (ring_buffer_is_empty(rb)) {
+            s_batch[i].armed = 0;
+            continue;
+        }
+        // 未配置打包时由自适应批量决定发送时机
+        if (passthrough && !net_batch_due(i, ring_buffer_num_items(rb), now)) {
+            continue;
+        }
+
+        // 本轮以同一个 head 为准，先取 tail 再取 head，保证 tail <= head
+        ring_buffer_size_t tail = ring_buffer_tail(rb);
+        ring_buffer_size_t head = ring_buffer_head(rb);
+        ring_buffer_size_t lag_limit = (ring_buffer_size_t)(RING_BUFFER_CAPACITY(rb) / 100) * channel->client_lag_limit_pct;
+
+        for (j = info->num_clients - 1; j >= 0; j--) {
+            int fd = info->client_fds[j];
+            ring_buffer_size_t pos = info->read_pos[j];
+            int closed = 0;
+            int sent_any = 0;
+
+            // 覆盖策略下生产者可能已越过该游标，被覆盖的字节已计入 rx_drop_count
+            if (head - pos > head - tail) {
+                pos = tail;
+            }
+
+            // 2. 积压检查 (只计已结束、可以发送的数据)，跳过积压时停在帧边界上
+            if (lag_limit > 0 && head - pos > head - ready && ready - pos > lag_limit) {
+                if (channel->client_lag_action == LAG_ACTION_DISCONNECT) {
+                    LOG_WARN("NetScheduler: Ch %d client fd=%d lags %u bytes, disconnecting.\n",
+                             i, fd, (unsigned int)(ready - pos));
+                    cleanup_data_connection(i, j);
+                    continue;
                 }
+                channel->lag_drop_count += ready - pos;
+                pos = ready;
             }
-        }
 
-        if (max_fd == 0) continue;
-
-        // 2. 非阻塞地检查哪些fd可写
-        int ret = select(max_fd + 1, NULL, &writefds, NULL, &timeout);
-
-        // 3. 仅当至少有一个客户端可写时，才从缓冲区取数据
-        if (ret > 0) {
-            
-            // 4. 从环形缓冲区读取一小块数据
-            // (我们依赖 `handle_serial_rx` 中 UART_HW_FIFO_SIZE 的定义)
-            unsigned int bytes_to_send = ring_buffer_dequeue_arr(
-                &channel->buffer_uart, (char*)temp_buffer_net_tx, TX_NET_SIZE);
-
-            if (bytes_to_send > 0) {
-                channel->rx_net += bytes_to_send;
-                
-                // 5. 将数据发送给 *所有可写的* 客户端
-                for (j = channel->data_net_info.num_clients - 1; j >= 0; j--) {
-                    int fd = channel->data_net_info.client_fds[j];
-                    
-                    // 检查这个 fd 是否在可写集合中
-                    if (fd >= 0 && FD_ISSET(fd, &writefds)) {
-                        
-                        // (由于 select() 保证了可写性，此处的 send() 不会阻塞)
-                        int sent = send(fd, (char*)temp_buffer_net_tx, bytes_to_send, 0);
-                        
-                        if (sent < 0) {
-                            // 理论上不应发生 EWOULDBLOCK，但如果发生，我们也忽略
-                            if (errno != EWOULDBLOCK && errno != EAGAIN) {
-                                // 发生真实错误 (如 RST)
-                                cleanup_data_connection(i, j);
-                            }
-                        }
+            // 3. 从该客户端自己的游标开始发送已结束的帧，每轮最多 TX_NET_SIZE 字节
+            // (fd 为非阻塞，直接尝试 sendmsg()，不再逐通道 select())
+            // UDP 模式每帧作为数据报发给所有目的地址，不会部分发送，也不因发送错误断开
+            int is_udp = (s_udp_slots[i] >> j) & 1;
+            if (is_udp && head - pos > head - ready) {
+                pos = send_udp_frames(i, fd, pos, ready, &info->send_stats[j], &sent_any);
+            }
+            ring_buffer_size_t budget = TX_NET_SIZE;
+            while (!is_udp && fd >= 0 && head - pos > head - ready && budget > 0) {
+                ClientSendStats* stats = &info->send_stats[j];
+                ring_buffer_size_t bytes_to_send;
+
+                // (socket 发送缓冲区满时 sendmsg() 返回 EWOULDBLOCK，不会阻塞)
+                // 字符间隔打包时一次只发一帧，其余情况一次发出尽可能多的帧
+                int sent = send_ready_frames(i, fd, pos, budget, &bytes_to_send);
+
+                if (sent > 0) {
+                    // 游标只按协议栈实际接受的字节数推进 (越过被剥离的分隔符)
+                    sent_any = 1;
+                    pos = packer_advance(i, pos, sent);
+                    stats->sent_bytes += sent;
+                    budget -= sent;
+                    if ((ring_buffer_size_t)sent < bytes_to_send) {
+                        stats->partial_sends++; // socket 发送缓冲区已满，剩余部分下次从游标继续
+                        break;
                     }
+                    continue;
+                } else if (sent == 0) {
+                    break;
+                } else if (sent < 0 && (errno == EWOULDBLOCK || errno == EAGAIN)) {
+                    stats->would_block++; // 数据仍在环形缓冲区中，下次从游标继续
+                } else if (sent < 0) {
+                    // 发生真实错误 (如 RST)
+                    stats->send_errors++;
+                    LOG_WARN("NetScheduler: Ch %d client fd=%d send error %d after %u bytes, disconnecting.\n",
+                             i, fd, errno, stats->sent_bytes);
+                    cleanup_data_connection(i, j);
+                    closed = 1;
+                }
+                break;
+            }
+
+            if (!closed) {
+                if (sent_any && (s_rx_stamp_mask & (1u << i))) {
+                    __atomic_fetch_and(&s_rx_stamp_mask, ~(1u << i), __ATOMIC_RELAXED);
+                    net_latency_record(i);
                 }
+                if (head - pos > head - ready) {
+                    s_send_blocked_slots[i] |= 1u << j; // 等待 socket 重新可写
+                }
+                info->read_pos[j] = pos;
             }
         }
+
+        // 最后一个客户端断开时环形缓冲区已被复位，不能再释放
+        if (info->num_clients == 0) {
+            continue;
+        }
+
+        // 4. 释放到最慢客户端的游标
+        ring_buffer_size_t slowest = head;
+        for (j = 0; j < info->num_clients; j++) {
+            if (head - info->read_pos[j] > head - slowest) {
+                slowest = info->read_pos[j];
+            }
+        }
+        if (slowest - tail <= head - tail) {
+            rt->rx_net += slowest - tail;
+        }
+        ring_buffer_release_to(rb, slowest);
+        packer_release(i, slowest);
     }
 }
 
+/**
+ * @brief 关闭一个未能接管的新连接
+ * @details TCP Client 目标的连接要先通知 ConnectionManagerTask，否则该目标一直停在已连接状态、不再重连。
+ */
+static void reject_new_connection(const NewConnectionMsg *msg)
+{
+	if (msg->type == CONN_TYPE_TCPCLIENT) {
+		ConnectionManager_NotifyDestinationClosed(msg->channel_index, msg->dest_index, msg->client_fd);
+	}
+	close(msg->client_fd);
+}
+
+/**
+ * @brief 按通道保存的串口参数打开串口
+ * @details Real COM 模式由驱动的配置命令 (init_usart) 打开串口；没有此命令的模式在第一个数据连接
+ * 接管时打开，使通道进入 g_channel_active_mask，最后一个数据连接断开时由 cleanup_data_connection() 关闭。
+ */
+static void channel_uart_open(int channel_index)
+{
+	ChannelState* channel = &g_system_config.channels[channel_index];
+	usart_info_t uart_info;
+
+	if (channel->baudrate <= 0) {
+		LOG_ERROR("NetScheduler: Ch %d has no valid baudrate (%d), UART not opened.\n",
+				  channel_index, channel->baudrate);
+		channel->uart_state = UART_STATE_ERROR;
+		return;
+	}
+	memset(&uart_info, 0, sizeof(uart_info));
+	uart_info.baud_rate = channel->baudrate;
+	uart_info.data_bit = channel->data_bits;
+	uart_info.stop_bit = channel->stop_bits;
+	uart_info.parity = channel->parity;
+	uart_info.mark = channel->mark;
+	uart_info.space = channel->space;
+	axi165502CInit(&uart_info, channel_index);
+	axi16550RxTriggerSet(channel_index, channel->rx_fifo_trigger);
+
+	channel->uart_state = UART_STATE_OPENED;
+	dev_channel_activity_update(channel_index);
+	LOG_INFO("NetScheduler: Ch %d UART opened at %d baud.\n", channel_index, channel->baudrate);
+}
+
 /**
  * @brief 清理一个已断开的数据连接
  */
@@ -288,26 +1363,66 @@ static void cleanup_data_connection(int channel_index,
 	}
 
 	int fd_to_close = channel->data_net_info.client_fds[client_index_in_array];
+	int dest_index = channel->data_net_info.dest_index[client_index_in_array];
+	poll_set_remove(fd_to_close);
+	if (dest_index >= 0) {
+		ConnectionManager_NotifyDestinationClosed(channel_index, dest_index, fd_to_close);
+	}
 	close(fd_to_close);
 
 	int last_index = channel->data_net_info.num_clients - 1;
 	if (client_index_in_array != last_index) {
 		channel->data_net_info.client_fds[client_index_in_array] =
 				channel->data_net_info.client_fds[last_index];
+		channel->data_net_info.read_pos[client_index_in_array] =
+				channel->data_net_info.read_pos[last_index];
+		channel->data_net_info.send_stats[client_index_in_array] =
+				channel->data_net_info.send_stats[last_index];
+		channel->data_net_info.dest_index[client_index_in_array] =
+				channel->data_net_info.dest_index[last_index];
+		// 被移动的客户端换了槽位，更新其在就绪集合中的标识
+		s_client_interest[channel_index][client_index_in_array] = s_client_interest[channel_index][last_index];
+		poll_set_modify(channel->data_net_info.client_fds[client_index_in_array],
+				s_client_interest[channel_index][client_index_in_array],
+				NET_POLL_TAG(channel_index, client_index_in_array));
+		if (s_send_blocked_slots[channel_index] & (1u << last_index)) {
+			s_send_blocked_slots[channel_index] |= 1u << client_index_in_array;
+		} else {
+			s_send_blocked_slots[channel_index] &= ~(1u << client_index_in_array);
+		}
+		if (s_udp_slots[channel_index] & (1u << last_index)) {
+			s_udp_slots[channel_index] |= 1u << client_index_in_array;
+		} else {
+			s_udp_slots[channel_index] &= ~(1u << client_index_in_array);
+		}
+		if (s_recv_ready_slots[channel_index] & (1u << last_index)) {
+			s_recv_ready_slots[channel_index] |= 1u << client_index_in_array;
+		} else {
+			s_recv_ready_slots[channel_index] &= ~(1u << client_index_in_array);
+		}
+	} else {
+		s_recv_ready_slots[channel_index] &= ~(1u << client_index_in_array);
 	}
+	s_send_blocked_slots[channel_index] &= ~(1u << last_index);
+	s_udp_slots[channel_index] &= ~(1u << last_index);
+	s_recv_ready_slots[channel_index] &= ~(1u << last_index);
 	channel->data_net_info.client_fds[last_index] = -1;
 	channel->data_net_info.num_clients--;
+	dev_channel_activity_update(channel_index);
 
 	if (channel->data_net_info.num_clients == 0) {
 		// 最后一个客户端断开，状态从 CONNECTED 变回 LISTENING
+		// 先关闭串口状态并等待进行中的收发周期结束，之后 tSerialIO 不再访问本通道的环形缓冲区，才能安全地归还
 		channel->data_net_info.state = NET_STATE_LISTENING;
 		channel->uart_state = UART_STATE_CLOSED;
+		dev_channel_activity_update(channel_index);
+		serial_io_quiesce();
 		// channel->tx_net = 0;
 		// channel->rx_net = 0;
 		// channel->rx_count = 0;
 		// channel->tx_count = 0;
-		ring_buffer_init(&channel->buffer_net,  channel->net_buffer_mem,  RING_BUFFER_SIZE);
-		ring_buffer_init(&channel->buffer_uart, channel->uart_buffer_mem, RING_BUFFER_SIZE);
+		// 存储区归还缓冲池，下一个客户端接入时按当时的 ring_size 重新分配
+		channel_buffers_detach(channel_index);
 		LOG_INFO(
 				"NetScheduler: Ch %d has no clients left. State -> LISTENING.\n",
 				channel_index);
@@ -319,11 +1434,11 @@ static void cleanup_data_connection(int channel_index,
 /**
  * @brief 用于独立测试网络调度器的任务入口函数
  * @details
- * 这个任务会以固定的频率循环执行网络调度的三个核心功能：
+ * 延时1秒后进入 NetworkSchedulerTask 的调度循环 (不再返回)，
+ * 由网络事件驱动执行网络调度的三个核心功能：
  * 1. 检查新连接 (check_for_new_connections)
  * 2. 处理网络数据接收 (run_net_recv)
  * 3. 处理网络数据发送 (run_net_send)
- * 任务末尾会有一个 taskDelay，以让出CPU给其他任务。
  */
 void NetSchedulerTestTask_Entry(void)
 {
@@ -331,12 +1446,109 @@ void NetSchedulerTestTask_Entry(void)
     printf("NetSchedulerTestTask_Entry... \r\n");
     taskDelay(sysClkRateGet());
 
-    for (;;)
-    {
-        // 调用原 NetworkSchedulerTask 的核心功能
-        NetworkSchedulerTask();
+    NetworkSchedulerTask();
+}
 
-        // 延时，让出 CPU，控制任务执行频率
-        taskDelay(sysClkRateGet()/800); // 大约每 1.25ms 执行一次
+/**
+ * @brief 切换网络调度方式 (Shell 调试接口)
+ * @param event_driven 1: 事件驱动 (默认)；0: 固定 5ms 周期轮询，用于对比延迟。
+ */
+void net_sched_mode_set(int event_driven)
+{
+    if (event_driven && s_wake_fd == ERROR) {
+        printf("net_sched_mode_set: wake pipe not available\n");
+        return;
+    }
+    s_event_driven = event_driven ? 1 : 0;
+    net_latency_clear();
+    net_scheduler_wake();
+}
+
+/**
+ * @brief 打印“串口数据就绪到首次网络发送”的延迟直方图
+ */
+void net_latency_show(void)
+{
+    uint32_t total = 0;
+    int k;
+
+    for (k = 0; k < NET_LAT_BUCKETS; k++) {
+        total += s_latency_hist[k];
+    }
+    printf("net scheduler: %s, wakeups=%u, samples=%u, max=%u us\n",
+            s_event_driven ? "event-driven" : "5 ms polling", s_wakeups, total, s_latency_max);
+    for (k = 0; k < NET_LAT_BUCKETS; k++) {
+        if (s_latency_hist[k] == 0) {
+            continue;
+        }
+        printf("  %s%8u us : %10u  (%3u%%)\n",
+                (k == NET_LAT_BUCKETS - 1) ? ">=" : " <",
+                (k == NET_LAT_BUCKETS - 1) ? (1u << (k - 1)) : (1u << k),
+                s_latency_hist[k], s_latency_hist[k] * 100 / total);
+    }
+}
+
+/**
+ * @brief 清零延迟直方图
+ */
+void net_latency_clear(void)
+{
+    memset(s_latency_hist, 0, sizeof(s_latency_hist));
+    s_latency_max = 0;
+    s_wakeups = 0;
+}
+
+/**
+ * @brief 打印未配置打包参数的通道的自适应批量状态
+ */
+void net_batch_show(void)
+{
+    int i;
+    int hz = sysClkRateGet();
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        ChannelState* channel = &g_system_config.channels[i];
+        NetBatchCtl* b = &s_batch[i];
+
+        if (channel->data_net_info.num_clients == 0 || !packer_is_passthrough(&channel->packing_settings)) {
+            continue;
+        }
+        printf("Ch %2d: batch=%5u bytes  wait=%4u ms  bound=%4u ms  rate=%6u bytes/bound  (cfg %d ms / %d bytes)\n",
+                i, (unsigned int)b->batch, (unsigned int)(b->interval * 1000 / hz),
+                (unsigned int)(b->bound * 1000 / hz), b->rate,
+                channel->net_send_cfg.send_interval_ms, channel->net_send_cfg.packet_size);
+    }
+}
+
+/**
+ * @brief 设置网络接收每轮的总字节数上限
+ * @details 上限越小，单轮耗时越短，各通道轮流得越快；不应小于 NET_RECV_QUANTUM。
+ */
+void net_recv_budget_set(int bytes)
+{
+    if (bytes < NET_RECV_QUANTUM) {
+        printf("net_recv_budget_set: budget must be at least %d bytes\n", NET_RECV_QUANTUM);
+        return;
     }
-}
\ No newline at end of file
+    s_recv_budget = bytes;
+}
+
+/**
+ * @brief 打印网络接收的每通道服务统计
+ */
+void net_recv_show(void)
+{
+    int i;
+
+    printf("net recv: budget=%d bytes/pass, quantum=%d bytes, next channel=%d, paused mask=0x%04x\n",
+            s_recv_budget, NET_RECV_QUANTUM, s_recv_next_ch, s_net_paused_mask);
+    for (i = 0; i < NUM_PORTS; i++) {
+        NetRecvStats* st = &s_recv_stats[i];
+
+        if (st->turns == 0) {
+            continue;
+        }
+        printf("Ch %2d: bytes=%10u  turns=%8u  deferred=%8u  paused=%6u  water=%u/%u\n", i, st->bytes, st->turns,
+                st->deferred, st->paused, (unsigned)s_net_low_water[i], (unsigned)s_net_high_water[i]);
+    }
+}
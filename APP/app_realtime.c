@@ -10,15 +10,32 @@
  * =====================================================================================
  */
 #include "./inc/app_com.h"
+#include "./inc/app_net_scheduler.h"
+#include "./inc/app_net_packing.h"
 #include "./HAL/hal_axi16550.h"
 #include <timers.h>     // For POSIX timers if used as fallback, or custom timer driver header
 #include <intLib.h>     // For intConnect()
+#include <taskLib.h>
+#include "./HAL/hal_timer.h"
 
 /* ------------------ Task-Specific Constants ------------------ */
 #define MEDIUM_FREQ_INTERVAL     (50)          // 中频任务执行间隔 (10 * 100µs = ms)
 #define LOW_FREQ_INTERVAL        (5*1000)     // 任务执行间隔 (1000ms)
 
-#define TX_CHUNK_SIZE (UART_HW_FIFO_SIZE / 2)
+// 串口收发的执行位置
+#define SERIAL_IO_MODE_ISR       (0)           // 在定时器ISR中直接收发 (原有方式)
+#define SERIAL_IO_MODE_TASK      (1)           // ISR只打时间戳并唤醒 tSerialIO 任务，由任务收发
+#define SERIAL_IO_MODE_IRQ       (2)           // 串口中断驱动：只处理产生中断的端口，仍由 tSerialIO 任务收发
+#define SERIAL_IO_MODE_DEFAULT   SERIAL_IO_MODE_TASK
+
+#define SERIAL_IO_TASK_PRIORITY   (20)         // 高于所有应用任务及网络协议栈任务
+#define SERIAL_IO_TASK_STACK_SIZE (8 * 1024)
+#define SERIAL_IO_TICK_BUDGET     (4 * 1024)   // 任务模式下每个周期最多搬运的字节数 (收或发)
+#define SERIAL_IO_NO_BUDGET       (0xFFFFFFFFu)
+
+// 发送节拍: 按字符时间推算发送FIFO的剩余字节数，FIFO未空时提前补充
+#define SERIAL_TX_GUARD           (4)          // 推算出的FIFO空闲字节数中保留不写的字节数
+#define SERIAL_TX_MIN_WRITE       (16)         // FIFO非空时空闲字节数达到此值才补充，减少对端口的访问
 
  // LED每次触发后点亮的持续时间（单位：中频任务周期，即50ms）
 #define LED_ON_DURATION_TICKS    (50)      
@@ -27,7 +44,19 @@
 static void high_precision_timer_isr(void *arg);
 static int setup_high_precision_timer(void);
 
-static void run_high_frequency_tasks(void);
+static void run_high_frequency_tasks(uint32_t budget);
+static void SerialIoTask(void);
+static uint32_t serial_port_rx(int i, ChannelRuntime *rt, uint32_t known, uint32_t max);
+static uint32_t serial_port_tx(int i, ChannelRuntime *rt, uint32_t max);
+static void uart_demux_isr(void *arg);
+static void serial_irq_service(uint32_t budget);
+static void serial_irq_disable_all(void);
+static unsigned int serial_irq_port_ier(int i);
+static int serial_irq_tick_needed(void);
+static void serial_rx_stamp_update(void);
+static uint32_t serial_tx_room(int i, int fifo_empty, UINT32 now);
+static void serial_tx_pacer_update(void);
+void serial_io_stats_clear(void);
 static void run_medium_frequency_tasks(void);
 static void run_low_frequency_tasks(void);
 
@@ -41,6 +70,51 @@ static void cleanup_data_connection(int channel_index,
 static SEM_ID s_timer_sync_sem; // 用于定时器ISR与任务同步的二进制信号量
 static volatile uint32_t timer_cnt = 0;
 
+/* 执行时间统计 (单位：sysTimestamp 计数) */
+typedef struct {
+    uint32_t last;
+    uint32_t max;
+    uint32_t count;
+    uint64_t sum;
+} ExecTimeStat;
+
+static SEM_ID s_serial_io_sem;                       // ISR唤醒 tSerialIO 任务
+static volatile int s_serial_io_mode = SERIAL_IO_MODE_DEFAULT;
+static volatile UINT32 s_isr_stamp;                  // 最近一次ISR入口的时间戳
+static volatile int s_serial_io_busy;                // tSerialIO 正在处理一个周期
+static volatile uint32_t s_serial_io_gen;            // 每个收发周期开始和结束时各加1，奇数表示周期进行中
+static volatile uint32_t s_serial_io_overrun;        // ISR到来时任务仍未处理完上一周期的次数
+static ExecTimeStat s_isr_stat;                      // ISR 执行时间
+static ExecTimeStat s_wakeup_stat;                   // ISR入口到任务开始处理的延迟
+static ExecTimeStat s_task_stat;                     // 任务每个周期的执行时间
+static ExecTimeStat s_uart_isr_stat;                 // 串口中断 (AXI_16550_INT) 执行时间
+
+/* 中断模式 (SERIAL_IO_MODE_IRQ) 的端口状态，按位对应端口号 */
+static volatile uint32_t s_irq_ports;                // 已开启串口中断的端口，仅 tSerialIO 修改
+static volatile uint32_t s_irq_pending;              // 已产生中断、等待 tSerialIO 处理的端口
+static unsigned int s_port_ier[NUM_PORTS];           // 最近一次写入各端口 IER 的值
+static unsigned char s_port_iir[NUM_PORTS];          // 中断服务程序读到的中断类型 (IIR_ID_*)
+
+/* 发送节拍: FPGA 只给出发送FIFO是否为空，FIFO中的字节数按上次写入后经过的字符时间推算 */
+typedef struct {
+    uint32_t level;                 // stamp 时刻发送FIFO中的字节数 (推算值，不小于实际值)
+    UINT32 stamp;                   // level 对应的接收时钟 s_rx_clock (单调计数，不受时间戳计数器周期限制)
+    volatile UINT32 char_q8;        // 每字符的 sysTimestamp 计数 x 256 (按 64/65 的线路速率计)，0 表示未知
+    uint32_t busy;                  // 上次检查时 buffer_net 有数据 (线路应保持忙碌)
+    uint32_t top_ups;               // FIFO未空时补充数据的次数
+    uint32_t underruns;             // 有数据待发时发现FIFO已空 (线路出现空闲) 的次数
+} SerialTxPacer;
+
+static SerialTxPacer s_tx_pacer[NUM_PORTS];
+static uint32_t s_tx_show_count[NUM_PORTS];          // serial_tx_show() 上次统计时的 tx_count
+static uint32_t s_tx_show_level[NUM_PORTS];          // serial_tx_show() 上次统计时推算的发送FIFO字节数
+static ULONG s_tx_show_tick;
+
+/* 接收时钟: 逐周期累加 sysTimestamp() 的增量，得到不受计数器周期限制的单调计数
+ * (字符间隔打包按此判断线路空闲，发送节拍按此推算FIFO中已发出的字符) */
+static UINT32 s_rx_clock;
+static UINT32 s_rx_last_stamp;
+
 static uint32_t s_last_rx_count[NUM_PORTS] = {0};
 static uint32_t s_last_tx_count[NUM_PORTS] = {0};
 static uint8_t s_rx_led_timer[NUM_PORTS] = {0};
@@ -61,11 +135,257 @@ void printHex(const char *buffer, size_t size)
 }
 
 
+static void exec_time_stat_update(ExecTimeStat *stat, UINT32 ticks)
+{
+    stat->last = ticks;
+    if (ticks > stat->max) {
+        stat->max = ticks;
+    }
+    stat->count++;
+    stat->sum += ticks;
+}
+
 static void high_precision_timer_isr(void *arg) {
-	// ISR中唯一要做的事：释放信号量唤醒实时任务
+	UINT32 start = sysTimestamp();
+
 	timer_cnt++;
 	semGive(s_timer_sync_sem);
-    run_high_frequency_tasks();
+	if (s_serial_io_mode != SERIAL_IO_MODE_ISR) {
+		// 任务/中断模式：只记录时间戳并唤醒 tSerialIO，串口收发不在中断上下文中执行；
+		// 中断模式下收发由串口中断启动，没有需要定时处理的端口时不唤醒
+		if (s_serial_io_mode != SERIAL_IO_MODE_IRQ || serial_irq_tick_needed()) {
+			if (s_serial_io_busy) {
+				s_serial_io_overrun++;
+			}
+			s_isr_stamp = start;
+			semGive(s_serial_io_sem);
+		}
+	} else {
+		__atomic_fetch_add(&s_serial_io_gen, 1, __ATOMIC_SEQ_CST);
+		run_high_frequency_tasks(SERIAL_IO_NO_BUDGET);
+		__atomic_fetch_add(&s_serial_io_gen, 1, __ATOMIC_SEQ_CST);
+	}
+	exec_time_stat_update(&s_isr_stat, hal_timestamp_elapsed(start, sysTimestamp()));
+}
+
+/**
+ * @brief tSerialIO 任务的主入口函数
+ * @details 每个定时器周期被ISR唤醒一次，在任务上下文中完成串口硬件FIFO与环形缓冲区之间的数据交换。
+ * 每个周期搬运的字节数受 SERIAL_IO_TICK_BUDGET 限制，避免长时间占用CPU。
+ */
+static void SerialIoTask(void)
+{
+    UINT32 start;
+
+    while (1) {
+        semTake(s_serial_io_sem, WAIT_FOREVER);
+        s_serial_io_busy = 1;
+        // 周期开始后才读取 g_channel_active_mask，与 serial_io_quiesce() 的检查顺序相对
+        __atomic_fetch_add(&s_serial_io_gen, 1, __ATOMIC_SEQ_CST);
+        start = sysTimestamp();
+        exec_time_stat_update(&s_wakeup_stat, hal_timestamp_elapsed(s_isr_stamp, start));
+
+        if (s_serial_io_mode == SERIAL_IO_MODE_IRQ) {
+            serial_irq_service(SERIAL_IO_TICK_BUDGET);
+        } else {
+            run_high_frequency_tasks(SERIAL_IO_TICK_BUDGET);
+        }
+
+        exec_time_stat_update(&s_task_stat, hal_timestamp_elapsed(start, sysTimestamp()));
+        __atomic_fetch_add(&s_serial_io_gen, 1, __ATOMIC_SEQ_CST);
+        s_serial_io_busy = 0;
+    }
+}
+
+/**
+ * @brief 等待进行中的串口收发周期结束 (归还通道的环形缓冲区之前调用)
+ * @details 调用者已把通道从 g_channel_active_mask 中清除，之后开始的周期不会再访问该通道；
+ * 调用时正在进行的周期可能已读到旧的位图 (SMP 上 tSerialIO 与调用者同时运行)，等到该周期结束。
+ * 单核上 tSerialIO 和定时器ISR在一个周期内都不会让出CPU，调用者运行时不会有进行中的周期，直接返回。
+ */
+void serial_io_quiesce(void)
+{
+    uint32_t gen = __atomic_load_n(&s_serial_io_gen, __ATOMIC_SEQ_CST);
+
+    if (gen & 1) {
+        while (__atomic_load_n(&s_serial_io_gen, __ATOMIC_SEQ_CST) == gen) {
+            taskDelay(0);
+        }
+    }
+}
+
+/**
+ * @brief 16个串口共用的中断 (AXI_16550_INT) 服务程序
+ * @details 只读取已开启中断端口的 IIR。产生中断的端口先屏蔽其 IER (中断为电平触发，
+ * 否则数据读走前会立即重入)，记入 s_irq_pending 后唤醒 tSerialIO 处理。
+ */
+static void uart_demux_isr(void *arg)
+{
+	UINT32 start = sysTimestamp();
+	uint32_t ports = s_irq_ports;
+	uint32_t raised = 0;
+	unsigned int iir;
+	int i;
+
+	for (i = 0; i < NUM_PORTS; i++) {
+		if (ports & (1u << i)) {
+			iir = axi16550IntId(i);
+			if (!(iir & IIR_NO_INT)) {
+				axi16550IntEnable(i, 0);
+				s_port_iir[i] = iir & IIR_ID_MASK;
+				raised |= (1u << i);
+			}
+		}
+	}
+	if (raised) {
+		s_irq_pending |= raised;
+		s_isr_stamp = start;
+		semGive(s_serial_io_sem);
+	}
+	exec_time_stat_update(&s_uart_isr_stat, hal_timestamp_elapsed(start, sysTimestamp()));
+}
+
+/**
+ * @brief 中断模式下的串口收发处理 (tSerialIO 任务上下文)
+ * @details 只访问产生过中断的端口的硬件寄存器，接收数据的时机由FIFO触发等级和字符超时决定。
+ * 每个周期还按环形缓冲区状态重新计算各活跃端口的 IER：
+ * - buffer_net 有数据时开启 THRE 中断，发送FIFO空时触发，由此启动发送；
+ * - BLOCK 策略下 buffer_uart 已满时关闭接收中断，待有空间后再开启。
+ * 只有 IER 需要改变时才写寄存器，空闲端口不产生任何总线访问。
+ *
+ * @param budget 本周期最多搬运的字节数，超出预算的端口保持屏蔽并留到下一周期。
+ */
+static void serial_irq_service(uint32_t budget)
+{
+	uint32_t pending, bit, ports;
+	uint32_t active = g_channel_active_mask;
+	uint32_t used = 0;
+	uint32_t known;
+	unsigned int ier;
+	int i, key;
+
+	key = intLock();
+	pending = s_irq_pending;
+	s_irq_pending = 0;
+	intUnlock(key);
+
+	serial_rx_stamp_update();
+
+	// 只遍历活跃通道和仍开着中断 (需要关闭) 的通道
+	ports = active | s_irq_ports;
+	while (ports) {
+		i = __builtin_ctz(ports);
+		bit = (1u << i);
+		ports &= ~bit;
+		ChannelState* channel = &g_system_config.channels[i];
+		ChannelRuntime* rt = &g_system_config.runtime[i];
+
+		// 只为有客户端连接且串口已打开的通道开启中断
+		if (!(active & bit)) {
+			if (s_irq_ports & bit) {
+				s_irq_ports &= ~bit;
+				s_port_ier[i] = 0;
+				axi16550IntEnable(i, 0);
+			}
+			continue;
+		}
+
+		if (pending & bit) {
+			if (used >= budget) {
+				key = intLock();
+				s_irq_pending |= bit;
+				intUnlock(key);
+				continue;
+			}
+			// RDA 表示接收FIFO至少已有触发等级的字节数，字符超时表示至少有1个字节
+			if (s_port_iir[i] == IIR_ID_RDA) {
+				known = axi16550RxTriggerBytes(channel->rx_fifo_trigger);
+			} else if (s_port_iir[i] == IIR_ID_TIMEOUT) {
+				known = 1;
+			} else {
+				known = 0;
+			}
+			used += serial_port_rx(i, rt, known, budget - used);
+			// THRE 表示发送FIFO已空，可以写满整个FIFO
+			if (!ring_buffer_is_empty(&rt->buffer_net) && axi16550_TxReady(i)) {
+				used += serial_port_tx(i, rt, UART_HW_FIFO_SIZE);
+			}
+		}
+
+		ier = serial_irq_port_ier(i);
+		// 中断服务程序已屏蔽产生中断的端口，需重新写入
+		if ((pending & bit) || !(s_irq_ports & bit) || ier != s_port_ier[i]) {
+			s_port_ier[i] = ier;
+			s_irq_ports |= bit;
+			axi16550IntEnable(i, ier);
+		}
+	}
+}
+
+/**
+ * @brief 按环形缓冲区状态计算活跃端口应开启的中断
+ * @details buffer_net 有数据时开启 THRE；BLOCK 策略下 buffer_uart 已满时关闭接收中断。
+ */
+static unsigned int serial_irq_port_ier(int i)
+{
+	ChannelRuntime* rt = &g_system_config.runtime[i];
+	unsigned int ier = 0;
+
+	if (ring_buffer_num_free(&rt->buffer_uart) > 0
+			|| g_system_config.channels[i].overflow_policy != OVERFLOW_POLICY_BLOCK) {
+		ier |= IER_RDA;
+	}
+	if (!ring_buffer_is_empty(&rt->buffer_net)) {
+		ier |= IER_THRE;
+	}
+	return ier;
+}
+
+/**
+ * @brief 中断模式下定时器周期是否需要唤醒 tSerialIO (定时器ISR调用)
+ * @details 数据收发由串口中断启动，定时器周期只在以下情况唤醒任务:
+ * - 有端口的 IER 需要改写: 通道刚激活或已失去客户端、buffer_net 有了新数据、
+ *   BLOCK 策略下 buffer_uart 重新有了空间；
+ * - 有因预算耗尽留到下一周期的端口；
+ * - 有尚未结束的字符间隔帧，需要按接收时钟判断线路是否已空闲。
+ * 只读取内存中的状态，不访问端口寄存器；空闲端口不会使任务被唤醒。
+ */
+static int serial_irq_tick_needed(void)
+{
+	uint32_t active = g_channel_active_mask;
+	uint32_t ports = active;
+	int i;
+
+	if (active != s_irq_ports || s_irq_pending != 0 || packer_gap_pending()) {
+		return 1;
+	}
+	while (ports) {
+		i = __builtin_ctz(ports);
+		ports &= ports - 1;
+		if (serial_irq_port_ier(i) != s_port_ier[i]) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief 关闭所有端口的串口中断 (离开中断模式时调用)
+ */
+static void serial_irq_disable_all(void)
+{
+	int i, key;
+
+	key = intLock();
+	for (i = 0; i < NUM_PORTS; i++) {
+		if (s_irq_ports & (1u << i)) {
+			axi16550IntEnable(i, 0);
+		}
+		s_port_ier[i] = 0;
+	}
+	s_irq_ports = 0;
+	s_irq_pending = 0;
+	intUnlock(key);
 }
 
 void uart_test()
@@ -84,12 +404,18 @@ void uart_test()
         axi165502CInit(&uart_info, i);
 
         ChannelState* channel = &g_system_config.channels[i];
+        ChannelRuntime* rt = &g_system_config.runtime[i];
+        if (rt->buffer_net.buffer == NULL && channel_buffers_attach(i) != OK) {
+            printf("uart_test: ch %d no ring buffer memory\n", i);
+            continue;
+        }
         channel->uart_state = UART_STATE_OPENED;
+        dev_channel_activity_update(i);
         // send data
-        channel->tx_net = 0;
+        rt->tx_net = 0;
         for(j=0;j<uart_info.baud_rate/100;j++){
-            ring_buffer_queue_arr(&channel->buffer_net,(const char*) test_data,sizeof(test_data));
-            channel->tx_net += sizeof(test_data);
+            ring_buffer_spsc_queue_arr(&rt->buffer_net,(const char*) test_data,sizeof(test_data));
+            rt->tx_net += sizeof(test_data);
         }
     }
     printf("uart_test end...\n");
@@ -110,7 +436,27 @@ void RealTimeSchedulerTask(void) {
 		return;
 	}
 
-	// 2. 设置并启动高精度硬件定时器
+	// 2. 创建串口收发任务 (任务模式下由ISR唤醒)
+	s_serial_io_sem = semBCreate(SEM_Q_PRIORITY, SEM_EMPTY);
+	if (s_serial_io_sem == NULL) {
+		LOG_ERROR(
+				"FATAL: RealTimeSchedulerTask failed to create serial I/O semaphore.\n");
+		return;
+	}
+	if (taskSpawn("tSerialIO", SERIAL_IO_TASK_PRIORITY, 0,
+			SERIAL_IO_TASK_STACK_SIZE, (FUNCPTR) SerialIoTask,
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0) == ERROR) {
+		LOG_ERROR("FATAL: RealTimeSchedulerTask failed to spawn tSerialIO.\n");
+		return;
+	}
+
+	// 3. 挂接串口中断，各端口的 IER 仅在中断模式下开启
+	if (intConnect(INUM_TO_IVEC(AXI_16550_INT), (VOIDFUNCPTR) uart_demux_isr, 0) != OK
+			|| intEnable(AXI_16550_INT) != OK) {
+		LOG_ERROR("RealTimeSchedulerTask: failed to connect UART interrupt, IRQ mode unavailable.\n");
+	}
+
+	// 4. 设置并启动高精度硬件定时器
 	if (setup_high_precision_timer() != OK) {
 		LOG_ERROR(
 				"FATAL: RealTimeSchedulerTask failed to setup high-precision timer.\n");
@@ -121,7 +467,7 @@ void RealTimeSchedulerTask(void) {
 
 	/* ------------------ 主调度循环 ------------------ */
 	while (1) {
-		// 3. 等待下一个100µs定时器中断信号，任务在此阻塞，不消耗CPU
+		// 5. 等待下一个100µs定时器中断信号，任务在此阻塞，不消耗CPU
 		semTake(s_timer_sync_sem, WAIT_FOREVER);
         minor_cycle_counter++;
 		/* --- 100µs 高频任务 --- */
@@ -137,67 +483,291 @@ void RealTimeSchedulerTask(void) {
 	}
 }
 
+/**
+ * @brief 读取单个端口的串口接收FIFO
+ * @details 直接写入软件环形缓冲区的空闲区域。缓冲区满时按通道的溢出策略处理，丢失的字节计入 rx_drop_count。
+ *
+ * @param known 已知接收FIFO中至少有的字节数，这部分连续读取而不查询LSR。
+ * @param max 本次最多读取的字节数。
+ * @return uint32_t 从硬件FIFO读出的字节数。
+ */
+static uint32_t serial_port_rx(int i, ChannelRuntime *rt, uint32_t known, uint32_t max)
+{
+    // 缓冲区满时的中转区 (仅在非 BLOCK 策略下使用，高频任务为唯一使用者)
+    static char s_rx_overflow_buf[UART_HW_FIFO_SIZE];
+    int overflow = 0;
+    OverflowPolicy policy;
+    uint32_t bytes_count = 0;
+    uint32_t used = 0;
+    char *span;
+    ring_buffer_size_t span_len;
+    ring_buffer_size_t fill = ring_buffer_num_items(&rt->buffer_uart);
+
+    // 字符间隔打包: 帧边界必须先于新数据交给网络调度任务
+    packer_gap_rx(i, ring_buffer_head(&rt->buffer_uart), s_rx_clock);
+
+    // 环形缓冲区的空闲区域最多分为两段 (回绕前/回绕后)，填满后再按溢出策略处理一次
+    while (!overflow && used < max) {
+        span_len = ring_buffer_reserve(&rt->buffer_uart, &span);
+        if (span_len == 0) {
+            // 溢出策略属于配置数据，只在缓冲区满时才读取
+            policy = g_system_config.channels[i].overflow_policy;
+            if (policy == OVERFLOW_POLICY_BLOCK) {
+                break; // 缓冲区已满，数据留在硬件FIFO中
+            }
+            span = s_rx_overflow_buf;
+            span_len = sizeof(s_rx_overflow_buf);
+            overflow = 1;
+        }
+        if (span_len > max - used) {
+            span_len = max - used;
+        }
+        // 从串口硬件非阻塞地读取FIFO数据，直接写入“串口到网络”的环形缓冲区 (高频任务为唯一生产者)
+        axi16550RecvBurst(i, (uint8_t*)span, known, span_len, &bytes_count);
+        if (bytes_count == 0) {
+            break;
+        }
+        known = (bytes_count < known) ? (known - bytes_count) : 0;
+        rt->rx_count += bytes_count;
+        used += bytes_count;
+        if (overflow) {
+            if (policy == OVERFLOW_POLICY_OVERWRITE_OLDEST) {
+                rt->rx_drop_count += ring_buffer_spsc_overwrite_arr(&rt->buffer_uart, span, bytes_count);
+            } else {
+                rt->rx_drop_count += bytes_count;
+            }
+            break;
+        }
+        ring_buffer_commit(&rt->buffer_uart, bytes_count);
+        if (bytes_count < span_len) {
+            break; // FIFO已读空
+        }
+    }
+    if (used > 0) {
+        net_scheduler_notify_rx(i, fill);
+    }
+    return used;
+}
+
+/**
+ * @brief 向单个端口的串口发送FIFO写入数据
+ * @details 直接从软件环形缓冲区的可读区域取数据，调用者需保证硬件FIFO至少有 max 字节空间。
+ *
+ * @param max 本次最多写入的字节数。
+ * @return uint32_t 写入硬件FIFO的字节数。
+ */
+static uint32_t serial_port_tx(int i, ChannelRuntime *rt, uint32_t max)
+{
+    uint32_t bytes_count;
+    uint32_t used = 0;
+    char *span;
+
+    // 一个块最多跨越回绕点分两段写出 (高频任务为唯一消费者)
+    while (used < max) {
+        bytes_count = ring_buffer_peek_span(&rt->buffer_net, &span);
+        if (bytes_count == 0) {
+            break;
+        }
+        if (bytes_count > max - used) {
+            bytes_count = max - used;
+        }
+        // 将数据直接从环形缓冲区写入串口硬件
+        axi16550SendNoWait(i, (uint8_t*)span, bytes_count);
+        ring_buffer_consume(&rt->buffer_net, bytes_count);
+        rt->tx_count += bytes_count;
+        used += bytes_count;
+    }
+    if (used > 0) {
+        net_scheduler_notify_tx(i);
+    }
+    return used;
+}
+
+/**
+ * @brief 推进本周期的接收时钟，并结束线路空闲已达到字符间隔的帧
+ * @details 每个周期取一次时间戳，同一周期内的收发共用。相邻周期的间隔小于时间戳计数器周期，
+ * 增量总是有效；周期被推迟超过计数器周期时只会少计时间 (帧结束得晚)，不会提前切断帧。
+ */
+static void serial_rx_stamp_update(void)
+{
+    UINT32 stamp = sysTimestamp();
+
+    s_rx_clock += hal_timestamp_elapsed(s_rx_last_stamp, stamp);
+    s_rx_last_stamp = stamp;
+    packer_gap_poll(s_rx_clock);
+}
+
 /**
  * @brief 串口接收处理函数
- * @details 从所有活跃的串口硬件FIFO读取数据，并存入软件环形缓冲区。
+ * @details 活跃通道位图与FPGA汇总的 RXRDYn 状态相与，只访问接收FIFO非空的端口，
+ * 每个周期的开销与忙碌端口数成正比。
  */
-static unsigned char temp_buffer[2048];
-static void handle_serial_rx(void)
+static uint32_t handle_serial_rx(uint32_t budget)
 {
-    int i;
-    size_t bytes_count = 0;
+    static int s_next_port = 0;         // 预算耗尽时下一周期从此端口继续
+    uint32_t ready, pass[2];
+    uint32_t used = 0;
+    int k, i;
 
-    for (i = 0; i < NUM_PORTS; i++) {
-        ChannelState* channel = &g_system_config.channels[i];
+    ready = g_channel_active_mask;
+    if (ready == 0) {
+        return 0;
+    }
+    ready &= UART_RX_Ready_Mask();
 
-        // 智能轮询：只处理有客户端连接且串口已打开的通道
-        if (channel->data_net_info.num_clients > 0 && channel->uart_state == UART_STATE_OPENED) 
-        {
-            // 从串口硬件非阻塞地读取FIFO中的所有数据
-            axi16550Recv(i, temp_buffer, &bytes_count);
-            if (bytes_count > 0) {
-                // 将读取到的数据放入“串口到网络”的环形缓冲区
-                ring_buffer_queue_arr(&channel->buffer_uart, (const char*)temp_buffer, bytes_count);
-                channel->rx_count += bytes_count;
+    // 先处理 s_next_port 及之后的端口，再回绕处理之前的端口
+    pass[0] = ready & (~0u << s_next_port);
+    pass[1] = ready & ~(~0u << s_next_port);
+    for (k = 0; k < 2; k++) {
+        while (pass[k]) {
+            i = __builtin_ctz(pass[k]);
+            pass[k] &= pass[k] - 1;
+            if (used >= budget) {
+                s_next_port = i;
+                return used;
             }
+            // RXRDYn 有效表示接收FIFO中至少有1个字节
+            used += serial_port_rx(i, &g_system_config.runtime[i], 1, budget - used);
         }
     }
+    s_next_port = 0;
+    return used;
+}
+
+/* stamp 之后线路至少已发出的字符数 (now 为接收时钟，按无符号差值跨越32位回绕) */
+static uint32_t serial_tx_sent(const SerialTxPacer *p, UINT32 now)
+{
+    if (p->char_q8 == 0) {
+        return 0;
+    }
+    return (uint32_t)(((UINT64)(UINT32)(now - p->stamp) << 8) / p->char_q8);
 }
 
 /**
- * @brief 串口发送处理函数
- * @details 从软件环形缓冲区取出数据，并写入所有活跃的串口硬件FIFO。
+ * @brief 估计端口发送FIFO当前可写入的字节数
+ * @details FIFO为空时可写满整个FIFO；非空时用上次写入后的字节数减去此后线路发出的字符数，
+ * 字符时间按略低于波特率的速率计，并另留 SERIAL_TX_GUARD 个字节，推算值不会小于实际字节数。
+ * 扣除已发出的字符时 stamp 只前进整数个字符时间，不足一个字符的部分留到下次。
+ * 时间按接收时钟 s_rx_clock 计: 它是单调累加的计数，线路连续忙碌超过时间戳计数器周期时 stamp
+ * 也不会越过 now；周期被推迟时只会少计时间，推算的FIFO字节数偏大，不会多写。
+ *
+ * @param fifo_empty FPGA 报告的发送FIFO为空 (TXRDYn)。
+ * @param now 本周期的接收时钟 s_rx_clock。
+ */
+static uint32_t serial_tx_room(int i, int fifo_empty, UINT32 now)
+{
+    SerialTxPacer *p = &s_tx_pacer[i];
+    uint32_t sent;
+
+    if (fifo_empty) {
+        if (p->busy) {
+            p->underruns++;
+        }
+        p->level = 0;
+        p->stamp = now;
+        return UART_HW_FIFO_SIZE;
+    }
+    if (p->char_q8 == 0) {
+        return 0; // 字符时间未知，只在FIFO为空时写入
+    }
+    sent = serial_tx_sent(p, now);
+    if (sent >= p->level) {
+        p->level = 0;
+        p->stamp = now;
+    } else {
+        p->level -= sent;
+        p->stamp += (UINT32)(((UINT64)sent * p->char_q8) >> 8);
+    }
+    if (p->level + SERIAL_TX_GUARD + SERIAL_TX_MIN_WRITE > UART_HW_FIFO_SIZE) {
+        return 0;
+    }
+    return UART_HW_FIFO_SIZE - SERIAL_TX_GUARD - p->level;
+}
+
+/**
+ * @brief 按各活跃端口的串口参数刷新字符时间 (中频任务调用)
  */
-static void handle_serial_tx(void)
+static void serial_tx_pacer_update(void)
 {
+    uint32_t ports = g_channel_active_mask;
+    UINT32 freq = sysTimestampFreq();
+    unsigned int bits;
     int i;
-    uint32_t bytes_count;
-    uint32_t tx_fifo_info;
-    // tx_fifo_info = UART_TX_FIFO_Info();
-    for (i = 0; i < NUM_PORTS; i++) {
-        ChannelState* channel = &g_system_config.channels[i];
 
-        // 智能轮询：只处理有客户端连接且串口已打开的通道
-        // if (channel->data_net_info.num_clients > 0 && channel->uart_state == UART_STATE_OPENED) 
-        if (channel->data_net_info.num_clients > 0 && channel->uart_state == UART_STATE_OPENED) 
-        {
+    while (ports) {
+        i = __builtin_ctz(ports);
+        ports &= ports - 1;
+        ChannelState* ch = &g_system_config.channels[i];
+
+        if (ch->baudrate <= 0 || freq == 0) {
+            s_tx_pacer[i].char_q8 = 0;
+            continue;
+        }
+        // 每个字符为起始位 + 数据位 + 校验位 + 停止位，速率按 64/65 计以抵消时钟误差
+        bits = 1 + ((ch->data_bits >= 5 && ch->data_bits <= 8) ? ch->data_bits : 8)
+                 + ((ch->parity != 0) ? 1 : 0) + ((ch->stop_bits >= 2) ? 2 : 1);
+        s_tx_pacer[i].char_q8 = (UINT32)(((UINT64)bits * freq * 256 * 65 / 64 + ch->baudrate - 1) / ch->baudrate);
+    }
+}
+
+/**
+ * @brief 串口发送处理函数
+ * @details 活跃通道位图与FPGA汇总的 TXRDYn 状态只各读取一次。发送FIFO为空的端口写满整个FIFO；
+ * 非空的端口按字符时间推算的空闲字节数补充数据 (serial_tx_room)，FIFO在下一次补充之前
+ * 不会发空，线路在数据发完之前保持连续忙碌。
+ */
+static uint32_t handle_serial_tx(uint32_t budget)
+{
+    static int s_next_port = 0;         // 预算耗尽时下一周期从此端口继续
+    uint32_t ready, empty, pass[2];
+    uint32_t room;
+    uint32_t used = 0;
+    UINT32 now;
+    int k, i;
+
+    ready = g_channel_active_mask;
+    if (ready == 0) {
+        return 0;
+    }
+    empty = UART_TX_Empty_Mask();
+    now = s_rx_clock;
+
+    pass[0] = ready & (~0u << s_next_port);
+    pass[1] = ready & ~(~0u << s_next_port);
+    for (k = 0; k < 2; k++) {
+        while (pass[k]) {
+            i = __builtin_ctz(pass[k]);
+            pass[k] &= pass[k] - 1;
+            ChannelRuntime* rt = &g_system_config.runtime[i];
+            SerialTxPacer* p = &s_tx_pacer[i];
+
             // 检查“网络到串口”缓冲区中是否有数据
-            if (!ring_buffer_is_empty(&channel->buffer_net)) 
-            {
-                // 检查串口硬件是否准备好接收数据
-                if (0 == UART_TX_FIFO_Ready(i)) 
-                {
-                    // 从环形缓冲区中取出数据
-                    bytes_count = ring_buffer_dequeue_arr(&channel->buffer_net, (char*)temp_buffer, TX_CHUNK_SIZE);
-                    if (bytes_count > 0) {
-                        // 将数据写入串口硬件
-                        axi16550SendNoWait(i, temp_buffer, bytes_count);
-                        channel->tx_count += bytes_count;
-                    }
-                }
+            if (ring_buffer_is_empty(&rt->buffer_net)) {
+                p->busy = 0;
+                continue;
             }
+            if (used >= budget) {
+                s_next_port = i;
+                return used;
+            }
+            room = serial_tx_room(i, (empty >> i) & 1, now);
+            if (room == 0) {
+                continue;
+            }
+            if (!((empty >> i) & 1)) {
+                p->top_ups++;
+            }
+            if (room > budget - used) {
+                room = budget - used;
+            }
+            room = serial_port_tx(i, rt, room);
+            p->level += room;
+            p->busy = 1;
+            used += room;
         }
     }
+    s_next_port = 0;
+    return used;
 }
 
 
@@ -205,21 +775,25 @@ static void handle_serial_tx(void)
  * @brief 执行所有高频（每个周期）任务
  * @details 负责在环形缓冲区和串口硬件FIFO之间高速交换数据。
  * 拆分为接收和发送两个独立循环，以提高逻辑清晰度。
+ *
+ * @param budget 本周期最多搬运的字节数，未处理完的端口在下一周期优先处理。
  */
-static void run_high_frequency_tasks(void)
+static void run_high_frequency_tasks(uint32_t budget)
 {
     static int call_count = 0;
     call_count++;
+    // 收发共用的接收时钟每个周期推进一次
+    serial_rx_stamp_update();
     // 1. 统一处理所有端口的接收
     if(call_count % 2 == 0)
     {
-        handle_serial_rx();
+        handle_serial_rx(budget);
     }else
 
 
     // 2. 统一处理所有端口的发送
     {
-        handle_serial_tx();
+        handle_serial_tx(budget);
     }
 }
 
@@ -233,13 +807,13 @@ static void handle_led_blinking(void)
 {
     int i;
     for (i = 0; i < NUM_PORTS; i++) {
-        ChannelState* channel = &g_system_config.channels[i];
+        ChannelRuntime* rt = &g_system_config.runtime[i];
 
         // --- 处理 RX LED ---
         // 1. 检测数据接收活动
-        if (channel->rx_count > s_last_rx_count[i]) {
+        if (rt->rx_count > s_last_rx_count[i]) {
             s_rx_led_timer[i] = LED_ON_DURATION_TICKS; // 重置点亮计时器
-            s_last_rx_count[i] = channel->rx_count;   // 更新上次的计数值
+            s_last_rx_count[i] = rt->rx_count;   // 更新上次的计数值
         }
 
         // 2. 根据计时器更新LED状态
@@ -252,9 +826,9 @@ static void handle_led_blinking(void)
 
         // --- 处理 TX LED ---
         // 1. 检测数据发送活动
-        if (channel->tx_count > s_last_tx_count[i]) {
+        if (rt->tx_count > s_last_tx_count[i]) {
             s_tx_led_timer[i] = LED_ON_DURATION_TICKS; // 重置点亮计时器
-            s_last_tx_count[i] = channel->tx_count;   // 更新上次的计数值
+            s_last_tx_count[i] = rt->tx_count;   // 更新上次的计数值
         }
 
         // 2. 根据计时器更新LED状态
@@ -271,15 +845,26 @@ static void handle_led_blinking(void)
  * @brief 执行所有中频（每1ms）任务
  */
 static void run_medium_frequency_tasks(void) {
-    NetworkSchedulerTask();
+    // 网络调度已移至独立的 tNetScheduler 任务，由网络事件驱动
+    serial_tx_pacer_update();
     // handle_led_blinking();
 }
 
 void channel_count_info(uint8_t channel_index)
 {
+    int j;
     ChannelState* channel = &g_system_config.channels[channel_index];
-    LOG_FATAL("[%d]:rx_count= %d, tx_count= %d", channel_index, channel->rx_count, channel->tx_count);
-    LOG_FATAL("[%d]:rx_net  = %d, tx_net  = %d", channel_index, channel->rx_net,   channel->tx_net);
+    ChannelRuntime* rt = &g_system_config.runtime[channel_index];
+    LOG_FATAL("[%d]:rx_count= %d, tx_count= %d", channel_index, rt->rx_count, rt->tx_count);
+    LOG_FATAL("[%d]:rx_net  = %d, tx_net  = %d", channel_index, rt->rx_net,   rt->tx_net);
+    LOG_FATAL("[%d]:rx_drop = %u, tx_drop = %u, lag_drop = %u, udp_reject = %u", channel_index, rt->rx_drop_count, rt->tx_drop_count,
+              channel->lag_drop_count, channel->udp_reject_count);
+    for (j = 0; j < channel->data_net_info.num_clients; j++) {
+        ClientSendStats* stats = &channel->data_net_info.send_stats[j];
+        LOG_FATAL("[%d]:client fd=%d sent=%u partial=%u wouldblock=%u err=%u", channel_index,
+                  channel->data_net_info.client_fds[j], stats->sent_bytes, stats->partial_sends,
+                  stats->would_block, stats->send_errors);
+    }
 
 }
 
@@ -294,8 +879,8 @@ void channel_count_info_all(void)
 
 void channel_buffer_cnt(uint8_t channel_index)
 {
-    ChannelState* channel = &g_system_config.channels[channel_index];
-    LOG_FATAL("[%d]:buffer_uart  = %d, buffer_net  = %d", channel_index, ring_buffer_num(&channel->buffer_uart), ring_buffer_num(&channel->buffer_net));
+    ChannelRuntime* rt = &g_system_config.runtime[channel_index];
+    LOG_FATAL("[%d]:buffer_uart  = %d, buffer_net  = %d", channel_index, ring_buffer_num(&rt->buffer_uart), ring_buffer_num(&rt->buffer_net));
 }
 
 void channel_buffer_cnt_all(void)
@@ -310,10 +895,15 @@ void channel_buffer_cnt_all(void)
 void channel_count_clr(uint8_t channel_index)
 {
     ChannelState* channel = &g_system_config.channels[channel_index];
-    channel->tx_net = 0;
-    channel->rx_net = 0;
-    channel->rx_count = 0;
-    channel->tx_count = 0;
+    ChannelRuntime* rt = &g_system_config.runtime[channel_index];
+    rt->tx_net = 0;
+    rt->rx_net = 0;
+    rt->rx_count = 0;
+    rt->tx_count = 0;
+    rt->rx_drop_count = 0;
+    rt->tx_drop_count = 0;
+    channel->lag_drop_count = 0;
+    channel->udp_reject_count = 0;
 }
 
 
@@ -360,3 +950,107 @@ void app_realtime_print(void)
 {
 	LOG_INFO("timer_cnt:%d \r\n",timer_cnt);
 }
+
+/**
+ * @brief 选择串口收发的执行位置 (调试shell调用)
+ *
+ * @param mode SERIAL_IO_MODE_ISR(0): 定时器ISR中收发; SERIAL_IO_MODE_TASK(1): tSerialIO任务中收发;
+ *             SERIAL_IO_MODE_IRQ(2): 串口中断驱动，tSerialIO任务中收发
+ */
+void serial_io_mode_set(int mode)
+{
+	if (mode != SERIAL_IO_MODE_ISR && mode != SERIAL_IO_MODE_TASK && mode != SERIAL_IO_MODE_IRQ) {
+		printf("serial_io_mode_set: invalid mode %d\n", mode);
+		return;
+	}
+	s_serial_io_mode = mode;
+	if (mode != SERIAL_IO_MODE_IRQ) {
+		serial_irq_disable_all();
+	}
+	serial_io_stats_clear();
+}
+
+static void exec_time_stat_print(const char *name, const ExecTimeStat *stat)
+{
+	uint32_t avg = (stat->count > 0) ? (uint32_t)(stat->sum / stat->count) : 0;
+
+	printf("%-8s count=%-10u last=%6u us  avg=%6u us  max=%6u us\n", name,
+			stat->count, hal_timestamp_to_us(stat->last),
+			hal_timestamp_to_us(avg), hal_timestamp_to_us(stat->max));
+}
+
+/**
+ * @brief 打印定时器ISR与 tSerialIO 任务的执行时间统计 (调试shell调用)
+ */
+void serial_io_stats_show(void)
+{
+	if (sysTimestampFreq() == 0) {
+		printf("serial_io_stats_show: timestamp timer not available\n");
+		return;
+	}
+	printf("serial I/O mode: %s\n",
+			(s_serial_io_mode == SERIAL_IO_MODE_IRQ) ? "irq (tSerialIO)" :
+			(s_serial_io_mode == SERIAL_IO_MODE_TASK) ? "task (tSerialIO)" : "isr");
+	exec_time_stat_print("isr", &s_isr_stat);
+	exec_time_stat_print("uart isr", &s_uart_isr_stat);
+	exec_time_stat_print("wakeup", &s_wakeup_stat);
+	exec_time_stat_print("task", &s_task_stat);
+	printf("task overrun: %u\n", s_serial_io_overrun);
+}
+
+/**
+ * @brief 清零执行时间统计 (调试shell调用)
+ */
+void serial_io_stats_clear(void)
+{
+	int key = intLock();
+
+	memset(&s_isr_stat, 0, sizeof(s_isr_stat));
+	memset(&s_wakeup_stat, 0, sizeof(s_wakeup_stat));
+	memset(&s_task_stat, 0, sizeof(s_task_stat));
+	memset(&s_uart_isr_stat, 0, sizeof(s_uart_isr_stat));
+	s_serial_io_overrun = 0;
+	intUnlock(key);
+}
+
+/**
+ * @brief 打印各端口的串口发送线路利用率 (调试shell调用)
+ * @details 利用率为上次调用以来线路发出的字符 (写入FIFO的字节数扣除FIFO中推算的积压) 占用的
+ * 线路时间与经过时间之比；underruns 为有数据待发时发送FIFO已发空的次数，接近0时线路连续忙碌。
+ */
+void serial_tx_show(void)
+{
+    ULONG now = tickGet();
+    ULONG ticks = now - s_tx_show_tick;
+    UINT32 clock = s_rx_clock;
+    unsigned int bits;
+    uint32_t bytes, level, sent;
+    int i;
+
+    printf("serial tx over %lu ms:\n", (unsigned long)(ticks * 1000 / sysClkRateGet()));
+    for (i = 0; i < NUM_PORTS; i++) {
+        ChannelState* ch = &g_system_config.channels[i];
+        SerialTxPacer* p = &s_tx_pacer[i];
+        UINT64 util = 0;
+
+        bytes = g_system_config.runtime[i].tx_count - s_tx_show_count[i];
+        s_tx_show_count[i] += bytes;
+        sent = serial_tx_sent(p, clock);
+        level = (sent < p->level) ? p->level - sent : 0;
+        bytes = bytes + s_tx_show_level[i] - level;
+        s_tx_show_level[i] = level;
+        if (bytes == 0 && p->top_ups == 0 && p->underruns == 0) {
+            continue;
+        }
+        if (ch->baudrate > 0 && ticks > 0) {
+            bits = 1 + ((ch->data_bits >= 5 && ch->data_bits <= 8) ? ch->data_bits : 8)
+                     + ((ch->parity != 0) ? 1 : 0) + ((ch->stop_bits >= 2) ? 2 : 1);
+            util = (UINT64)bytes * bits * 100 * sysClkRateGet() / ((UINT64)ch->baudrate * ticks);
+        }
+        printf("Ch %2d: baud=%7d  bytes=%10u  util=%3u%%  top-ups=%8u  underruns=%6u\n", i, ch->baudrate,
+               bytes, (unsigned)util, p->top_ups, p->underruns);
+        p->top_ups = 0;
+        p->underruns = 0;
+    }
+    s_tx_show_tick = now;
+}
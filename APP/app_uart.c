@@ -62,13 +62,53 @@ void calculate_send_parameters(ChannelState* channel)
         channel->net_send_cfg.packet_size = MAX_PACKET_SIZE;
     }
 
-    LOG_WARN("Channel send params - baudrate: %d, interval: %dms, packet size: %d", 
+    LOG_DEBUG("Channel send params - baudrate: %d, interval: %dms, packet size: %d", 
               baudrate, 
               channel->net_send_cfg.send_interval_ms,
               channel->net_send_cfg.packet_size);
 }
 
 
+/**
+ * @brief 根据波特率和工作模式计算通道环形缓冲区的容量
+ * @details 容量为线速下 RING_HOLD_MS_* 毫秒的数据量，向上取整为2的幂，
+ * 并限制在缓冲池块大小范围内。容量变化时置位 ring_resize_pending，
+ * 由网络调度任务在缓冲区为空时重新分配。
+ */
+void calculate_buffer_size(ChannelState* channel)
+{
+    unsigned int hold_ms;
+    unsigned int bytes;
+    unsigned int size = BUF_POOL_MIN_BLOCK;
+
+    switch (channel->op_mode) {
+        case OP_MODE_REAL_COM:
+        case OP_MODE_TCP_SERVER:
+            hold_ms = RING_HOLD_MS_SERVER;
+            break;
+        case OP_MODE_TCP_CLIENT:
+        case OP_MODE_UDP:
+            hold_ms = RING_HOLD_MS_PEER;
+            break;
+        default:
+            hold_ms = 0; // 禁用的通道只保留最小容量
+            break;
+    }
+
+    bytes = (unsigned int)(((unsigned long long)channel->baudrate * hold_ms) / (BITS_PER_CHAR * 1000));
+    while (size < bytes && size < BUF_POOL_MAX_BLOCK) {
+        size <<= 1;
+    }
+
+    if (channel->ring_size != size) {
+        channel->ring_size = size;
+        channel->ring_resize_pending = 1;
+    }
+
+    LOG_DEBUG("Channel ring size - baudrate: %d, op_mode: %d, size: %u",
+              channel->baudrate, channel->op_mode, size);
+}
+
 int init_usart(ChannelState *uart_instance, int client_socket, char *buf, int buf_len, int channel) {
 	int ret;
 	unsigned char stop_bit;
@@ -137,8 +177,10 @@ int init_usart(ChannelState *uart_instance, int client_socket, char *buf, int bu
 	}
 	/*调用AXI_api设置串口相关寄存器*/
 	axi165502CInit(&uart_info, channel);
+	axi16550RxTriggerSet(channel, uart_instance->rx_fifo_trigger);
 
 	uart_instance->uart_state = UART_STATE_OPENED;
+	dev_channel_activity_update(channel);
 
 	uart_instance->usart_mcr_dtr = (unsigned char) buf[4];
 
@@ -177,6 +219,7 @@ int init_usart(ChannelState *uart_instance, int client_socket, char *buf, int bu
 	 * */
 
 	calculate_send_parameters(uart_instance);
+	calculate_buffer_size(uart_instance);
 
 	//打包数据
 	pack_buf[0] = buf[0];
@@ -406,6 +449,42 @@ int usart_report_queue(int client_socket, char *buf, int buf_len) {
 
 }
 
+/**
+ * @brief 串口接收方向发生软件溢出时，向该通道的所有命令连接发送 ASPP_NOTIFY_SW_OVERRUN
+ * @details 比较 rx_drop_count 与上次通知时的值，每次新的丢失只通知一次。
+ * 由 ConfigTaskManager 周期调用 (命令连接的 fd 归该任务所有)。
+ */
+void usart_report_sw_overrun(int channel) {
+	static unsigned int s_reported_drops[NUM_PORTS];
+	ChannelState *ch = &g_system_config.channels[channel];
+	unsigned int drops = g_system_config.runtime[channel].rx_drop_count;
+	unsigned int last = s_reported_drops[channel];
+	char pack_buf[4];
+	int i;
+
+	if (drops == last) {
+		return;
+	}
+	s_reported_drops[channel] = drops;
+
+	// 计数被清零，或当前没有驱动连接，只同步不通知
+	if (drops < last || ch->cmd_net_info.num_clients == 0) {
+		return;
+	}
+
+	/*打包数据*/
+	pack_buf[0] = ASPP_CMD_NOTIFY;
+	pack_buf[1] = 0x02;
+	pack_buf[2] = ASPP_NOTIFY_SW_OVERRUN;
+	pack_buf[3] = (ch->cts_status ? UART_MSR_CTS : 0) | (ch->dsr_status ? UART_MSR_DSR : 0)
+			| (ch->dcd_status ? UART_MSR_DCD : 0);
+
+	LOG_WARN("Ch %d: %u bytes dropped on serial RX, notifying driver.\n", channel, drops - last);
+	for (i = 0; i < ch->cmd_net_info.num_clients; i++) {
+		socket_send_to_middle(ch->cmd_net_info.client_fds[i], pack_buf, sizeof(pack_buf));
+	}
+}
+
 int usart_close(int client_socket, char *buf, int buf_len) {
 	int ret;
 
@@ -26,6 +26,7 @@
 #include "./HAL/hal_com.h"
 #include "./HAL/hal_log.h"
 #include "./HAL/hal_ringbuffer.h"
+#include "./HAL/hal_bufpool.h"
 #include "app_dev.h"
 
 /* 网络端口定义 */
@@ -42,6 +43,10 @@
 #define MIN_PACKET_SIZE    4       // 最小包大小(字节)
 #define MAX_PACKET_SIZE    (256)    // 最大包大小(字节)
 
+// 环形缓冲区容量按线速缓冲时长计算
+#define RING_HOLD_MS_SERVER  1000   // Real COM / TCP Server: 可能有多个客户端，需容纳慢客户端
+#define RING_HOLD_MS_PEER    500    // TCP Client / UDP
+
 #define TIMER_TICK_US     100     // 定时器tick为100微秒
 #define US_TO_MS          1000    // 微秒转毫秒
 
@@ -130,6 +135,7 @@ typedef struct {
     ConnectionType type;          // 连接的类型
     int            channel_index; // 通道索引 (0-15)，对于全局配置为-1
     int            client_fd;     // 新建立的socket文件描述符
+    int            dest_index;    // TCP Client: tcp_destinations[] 的下标，其他类型为 -1
 } NewConnectionMsg;
 
 
@@ -138,7 +144,6 @@ typedef struct {
  * 在.c文件中定义的全局变量，在此处用extern声明，以便其他文件可以访问。
  */
 // 消息队列ID
-extern MSG_Q_ID g_net_conn_q[NUM_PORTS];
 extern MSG_Q_ID g_config_conn_q;
 
 // 互斥锁ID
@@ -151,5 +156,7 @@ extern void ConnectionManagerTask(void);
 
 extern void ConfigTaskManager(void);
 extern void RealTimeSchedulerTask(void);
+// 等待进行中的串口收发周期结束，调用前先把通道从 g_channel_active_mask 中清除
+extern void serial_io_quiesce(void);
 
 #endif /* APP_COMMON_H */
@@ -7,7 +7,6 @@
 /* ------------------ Application-Specific Constants ------------------ */
 #define NUM_PORTS               16      // 系统支持的串口/通道数量
 #define MAX_CLIENTS_PER_CHANNEL (DEFAULT_REAL_COM_MAX_CONNECTIONS)
-#define RING_BUFFER_SIZE        (512 * 1024) // 64KB 环形缓冲区大小
 #define MAX_CONFIG_CLIENTS      (NUM_PORTS * (MAX_CLIENTS_PER_CHANNEL+1) + 1) // 最大配置客户端数量
 
 #define MAX_ALIAS_LEN               19
@@ -72,6 +71,25 @@ typedef enum {
 } DelimiterProcess;
 
 
+/**
+ * @brief 定义环形缓冲区满时的溢出处理策略
+ * @details 对通道的两个方向 (buffer_uart / buffer_net) 同时生效。
+ * 例外: TCP 连接写入 buffer_net 总是在高水位暂停接收 (由 TCP 接收窗口限制发送方)，从不丢弃。
+ */
+typedef enum {
+    OVERFLOW_POLICY_OVERWRITE_OLDEST = 0x00, // 覆盖最旧的数据，新数据总能写入
+    OVERFLOW_POLICY_DROP_NEWEST      = 0x01, // 丢弃新到达的数据，保留缓冲区中已有的数据
+    OVERFLOW_POLICY_BLOCK            = 0x02  // 暂停生产者，数据留在串口硬件FIFO / socket中 (不计丢弃)
+} OverflowPolicy;
+
+/**
+ * @brief 定义数据客户端落后过多时的处理方式
+ */
+typedef enum {
+    LAG_ACTION_SKIP       = 0x00, // 丢弃该客户端积压的数据，从最新数据继续发送
+    LAG_ACTION_DISCONNECT = 0x01  // 断开该客户端
+} ClientLagAction;
+
 /**
  * @brief TCP远程目标端点定义
  * @details 包含目标IP、目标端口和本地源端口。
@@ -102,15 +120,30 @@ typedef struct {
     unsigned char  delimiter1;               // 分隔符1 (0x00-0xFF)
     unsigned char  delimiter2;               // 分隔符2 (0x00-0xFF)
     DelimiterProcess delimiter_process;      // 分隔符处理方式
+    unsigned char  char_gap;                 // 字符间隔打包: 线路空闲达到该字符时间数即结束一帧 (0 表示不启用)
 } DataPackingSettings;
 
 
+/**
+ * @brief 单个数据客户端的发送统计
+ * @details 部分发送和 EWOULDBLOCK 不丢数据 (剩余部分从该客户端的读游标继续)，只计数。
+ */
+typedef struct {
+	uint32_t sent_bytes;      // send() 成功发出的字节数
+	uint32_t partial_sends;   // send() 只接受了部分数据的次数
+	uint32_t would_block;     // send() 返回 EWOULDBLOCK/EAGAIN 的次数
+	uint32_t send_errors;     // send() 返回其他错误的次数 (随后断开该客户端)
+} ClientSendStats;
+
 /**
  * @brief 描述数据通道的网络状态和连接信息
  */
 typedef struct {
 	NetworkChannelState state;
 	int client_fds[MAX_CLIENTS_PER_CHANNEL];
+	ring_buffer_size_t read_pos[MAX_CLIENTS_PER_CHANNEL]; // 每个客户端在 buffer_uart 中的读游标 (自由递增的绝对位置)
+	ClientSendStats send_stats[MAX_CLIENTS_PER_CHANNEL];  // 与 client_fds 同一槽位
+	signed char dest_index[MAX_CLIENTS_PER_CHANNEL];      // TCP Client 连接对应的 tcp_destinations[] 下标，其他连接为 -1
 	int num_clients;
 } DataChannelInfo;
 
@@ -196,6 +229,7 @@ typedef struct {
     unsigned char parity;
     unsigned char flow_ctrl;
     unsigned char fifo_enable;
+    unsigned char rx_fifo_trigger;            // 接收FIFO触发等级 0..3 (中断模式下决定RDA中断的字节数)
     unsigned char interface_type;
     
     /* -- 串口控制参数 -- */
@@ -241,32 +275,56 @@ typedef struct {
     unsigned int op_mode_ip4;
 
     /* -- 实时数据缓冲区 -- */
-    ring_buffer_t buffer_net;
-    ring_buffer_t buffer_uart;
-    unsigned char net_buffer_mem[RING_BUFFER_SIZE];
-    unsigned char uart_buffer_mem[RING_BUFFER_SIZE];
+    OverflowPolicy overflow_policy;         // 缓冲区满时的溢出处理策略
+    unsigned char client_lag_limit_pct;     // 客户端积压超过 buffer_uart 容量的该百分比时触发 client_lag_action (0: 不限制)
+    ClientLagAction client_lag_action;      // 客户端落后过多时的处理方式
+    unsigned int ring_size;                 // 按波特率和工作模式计算的单向环形缓冲区容量 (字节)
+    volatile unsigned char ring_resize_pending; // ring_size 已变化，等待网络调度任务重新分配
+    // 环形缓冲区及收发计数在 SystemConfiguration.runtime[] 中 (见 ChannelRuntime)
 
     /* -- 运行时监控统计 (0x06) -- */
-    unsigned int tx_count;
-    unsigned int rx_count;
-    unsigned int tx_net;
-    unsigned int rx_net;
     unsigned long long tx_total_count;
     unsigned long long rx_total_count;
+    unsigned int lag_drop_count;            // 因客户端落后过多而被跳过的字节数 (按客户端累计)
+    unsigned int udp_reject_count;          // UDP 模式下来源不在 udp_destinations[] 范围内而被丢弃的数据报数
     unsigned char dsr_status;
     unsigned char cts_status;
     unsigned char dcd_status;
 } ChannelState;
 
+/** @brief ChannelRuntime 的对齐粒度 (Cortex-A9 的两条32字节cache行) */
+#define CHANNEL_RT_ALIGN        64
+
+/**
+ * @brief 串口收发路径每个周期都要访问的通道运行时数据
+ * @details 从 ChannelState 中拆出，16个通道紧凑排列在 SystemConfiguration.runtime[] 中，
+ * 每个通道独占对齐的cache行。ChannelState 中只保留配置和低频访问的状态。
+ */
+typedef struct {
+    ring_buffer_t buffer_net;               // 网络->串口，存储区在有数据客户端期间从缓冲池 (hal_bufpool) 分配
+    ring_buffer_t buffer_uart;              // 串口->网络
+    unsigned int tx_count;                  // 写入串口硬件的字节数
+    unsigned int rx_count;                  // 从串口硬件读出的字节数
+    unsigned int tx_net;                    // 从网络收到的字节数
+    unsigned int rx_net;                    // 已发往网络的字节数
+    unsigned int rx_drop_count;             // 串口->网络方向 (buffer_uart) 因溢出丢失的字节数
+    unsigned int tx_drop_count;             // 网络->串口方向 (buffer_net) 因溢出丢失的字节数
+} __attribute__((aligned(CHANNEL_RT_ALIGN))) ChannelRuntime;
+
 /**
  * @brief 包含整个系统所有配置的顶层结构体
  */
 typedef struct {
 	DeviceSettings device;
 	ChannelState channels[NUM_PORTS];
+	ChannelRuntime runtime[NUM_PORTS];      // 按通道索引与 channels[] 一一对应
 } SystemConfiguration;
 
 /* ------------------ Global Variable Declaration (extern) ------------------ */
+/** @brief 有数据客户端连接的通道位图 (bit n 对应通道 n)，网络调度任务只遍历这些通道。 */
+extern volatile uint32_t g_channel_client_mask;
+/** @brief 有数据客户端且串口已打开的通道位图，串口收发只处理这些通道。 */
+extern volatile uint32_t g_channel_active_mask;
 
 /* ------------------ Public API Functions ------------------ */
 
@@ -289,6 +347,14 @@ int dev_config_save(void);
  */
 void dev_config_load_defaults(void);
 
+/**
+ * @brief 按通道当前的 num_clients 与 uart_state 刷新 g_channel_client_mask / g_channel_active_mask
+ * @details 修改 data_net_info.num_clients 或 uart_state 之后必须调用。
+ *
+ * @param channel_index 通道索引 (0 to NUM_PORTS-1)。
+ */
+void dev_channel_activity_update(int channel_index);
+
 /**
  * @brief 重启设备
  */
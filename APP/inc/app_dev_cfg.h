@@ -19,6 +19,14 @@
 //--- Real COM Mode 默认配置参数 ---
 #define DEFAULT_COM_BAUDRATE                115200
 #define DEFAULT_COM_INTERFACE_TYPE          INTERFACE_TYPE_RS232               
+/** @brief 接收FIFO触发等级 (2: 半满)，中断模式下兼顾中断次数与FIFO余量。 */
+#define DEFAULT_COM_RX_FIFO_TRIGGER         2
+/** @brief 环形缓冲区溢出策略 (暂停生产者，依靠TCP流控反压)。 */
+#define DEFAULT_COM_OVERFLOW_POLICY         OVERFLOW_POLICY_BLOCK
+/** @brief 客户端积压上限 (占 buffer_uart 容量的百分比)，留出余量使慢客户端不会阻塞其他客户端。 */
+#define DEFAULT_COM_CLIENT_LAG_LIMIT_PCT    75
+/** @brief 客户端积压超限时的处理方式。 */
+#define DEFAULT_COM_CLIENT_LAG_ACTION       LAG_ACTION_SKIP
 
 //--------------------------------------------------------------------------------------
 
@@ -42,6 +50,8 @@
 #define DEFAULT_REAL_COM_DELIMITER_PROCESS    DELIMITER_PROCESS_NONE
 /** @brief 强制发送时间 (毫秒, 0表示禁用)。 */
 #define DEFAULT_REAL_COM_FORCE_TRANSMIT_TIME  0
+/** @brief 字符间隔打包 (字符时间数, 0表示禁用)。 */
+#define DEFAULT_REAL_COM_CHAR_GAP             0
 
 //--------------------------------------------------------------------------------------
 //--- TCP Server Mode 默认配置参数 ---
@@ -69,6 +79,8 @@
 #define DEFAULT_TCPSERVER_DELIMITER_PROCESS    DELIMITER_PROCESS_NONE
 /** @brief 强制发送时间 (毫秒, 0表示禁用)。 */
 #define DEFAULT_TCPSERVER_FORCE_TRANSMIT_TIME  0
+/** @brief 字符间隔打包 (字符时间数, 0表示禁用)。 */
+#define DEFAULT_TCPSERVER_CHAR_GAP             0
 /** @brief 本地监听的数据端口。 */
 #define DEFAULT_TCPSERVER_LOCAL_TCP_PORT       4001
 /** @brief 本地监听的命令端口。 */
@@ -98,6 +110,8 @@
 #define DEFAULT_TCPCLIENT_DELIMITER_PROCESS    DELIMITER_PROCESS_NONE
 /** @brief 强制发送时间 (毫秒, 0表示禁用)。 */
 #define DEFAULT_TCPCLIENT_FORCE_TRANSMIT_TIME  0
+/** @brief 字符间隔打包 (字符时间数, 0表示禁用)。 */
+#define DEFAULT_TCPCLIENT_CHAR_GAP             0
 /** @brief 目标IP地址1 (0.0.0.0)。 */
 #define DEFAULT_TCPCLIENT_DEST_IP1             0
 /** @brief 目标端口1。 */
@@ -141,6 +155,8 @@
 #define DEFAULT_UDP_DELIMITER_PROCESS          DELIMITER_PROCESS_NONE
 /** @brief 强制发送时间 (毫秒, 0表示禁用)。 */
 #define DEFAULT_UDP_FORCE_TRANSMIT_TIME        0
+/** @brief 字符间隔打包 (字符时间数, 0表示禁用)。 */
+#define DEFAULT_UDP_CHAR_GAP                   0
 /** @brief 目标起始IP地址1 (0.0.0.0)。 */
 #define DEFAULT_UDP_DEST_BEGIN_IP1             0
 /** @brief 目标结束IP地址1 (0.0.0.0)。 */
@@ -50,4 +50,18 @@ STATUS ConnectionManager_RequestReconfigure(int channel_index);
  */
 STATUS ConnectionManager_NotifyConnectionClosed(int channel_index);
 
+/**
+ * @brief 通知 ConnectionManagerTask 一个 TCP Client 目标的连接已关闭
+ *
+ * 只设置该目标的关闭标志，不经过消息队列，因此不会丢失。ConnectionManagerTask 在下一轮
+ * 看到标志后按该目标自己的退避间隔重新连接，其他目标不受影响。应在 close() 之前调用，
+ * 否则 fd 号可能已被新连接复用。
+ *
+ * @param channel_index 连接所属的通道号 (0-15)
+ * @param dest_index    tcp_destinations[] 的下标 (0-3)
+ * @param client_fd     要关闭的 fd，用于忽略通道重新配置之前的旧连接
+ * @return STATUS OK on success, ERROR if the arguments are out of range.
+ */
+STATUS ConnectionManager_NotifyDestinationClosed(int channel_index, int dest_index, int client_fd);
+
 #endif // __APP_NET_CON_H__
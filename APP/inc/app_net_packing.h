@@ -0,0 +1,105 @@
+#ifndef APP_NET_PACKING_H_
+#define APP_NET_PACKING_H_
+
+#include "app_com.h"
+
+/**
+ * @file app_net_packing.h
+ * @brief “串口到网络”方向的数据打包 (DataPackingSettings)
+ *
+ * 打包器位于 buffer_uart 与数据客户端之间，只记录帧边界，数据仍留在环形缓冲区中。
+ * 一帧在以下任一条件满足时结束：
+ * 1. 达到 packing_length 字节；
+ * 2. 收到分隔符 (delimiter1，或 delimiter1 后紧跟 delimiter2)，并按 delimiter_process
+ *    原样保留、剥离分隔符，或再等待分隔符之后的 1/2 个字节；
+ * 3. 超过 force_transmit_time_ms 没有收到新数据；
+ * 4. 串口线路空闲达到 char_gap 个字符时间 (按波特率、数据位、校验位和停止位计算)。
+ * 分隔符为 0x00 表示未启用。各项均未配置时收到的数据立即成帧 (直通)。
+ * 只有已结束的帧才会发给客户端。字符间隔由串口接收侧按每周期的接收时钟判断，
+ * 在帧边界处记录标记交给网络调度任务；启用字符间隔时每帧单独用一次 send() 发出，相邻帧不合并。
+ * UDP 模式下配置了打包参数时同样不合并，每帧成为一个数据报。
+ * 除 packer_gap_* 外的接口只在网络调度任务中调用。
+ */
+
+#define PACK_MAX_FRAMES      (32)   // 每通道已结束但尚未被所有客户端发完的帧数上限 (2的幂)
+#define PACK_GAP_MARKS       (16)   // 每通道待网络调度任务处理的字符间隔帧边界数 (2的幂)
+
+// 分隔符扫描方式: 1 = 按机器字 (SWAR) 一次比较多个字节，0 = 逐字节比较
+#ifndef PACK_SCAN_SWAR
+#define PACK_SCAN_SWAR       (1)
+#endif
+
+/**
+ * @brief 判断打包参数是否均未配置 (直通: 收到的数据立即成帧，发送时机由网络调度任务决定)
+ */
+BOOL packer_is_passthrough(const DataPackingSettings *cfg);
+
+/**
+ * @brief 复位通道的打包状态，下一帧从 pos 开始
+ * @details 环形缓冲区重新分配后调用。
+ */
+void packer_reset(int channel_index, ring_buffer_size_t pos);
+
+/**
+ * @brief 扫描 buffer_uart 中新到达的数据并结束满足条件的帧
+ *
+ * @param now 当前 tickGet()。
+ * @return ring_buffer_size_t 可发送数据的结束位置 (最后一个已结束帧的末尾)。
+ */
+ring_buffer_size_t packer_update(int channel_index, ULONG now);
+
+/**
+ * @brief 获取通道的强制发送截止时间
+ *
+ * @return BOOL TRUE 表示有未结束的帧在等待超时，截止 tick 写入 deadline。
+ */
+BOOL packer_deadline(int channel_index, ULONG *deadline);
+
+/**
+ * @brief 新客户端接入时的读游标：当前未结束帧的起点，保证客户端从帧边界开始接收
+ */
+ring_buffer_size_t packer_join_pos(int channel_index);
+
+/**
+ * @brief 为从 pos 开始的已结束帧构造 iovec (直接指向环形缓冲区，跳过被剥离的分隔符)
+ *
+ * @param max 最多包含的字节数。
+ * @param total 输出 iovec 的总字节数。
+ * @return int iovec 的项数，0 表示没有可发送的数据。
+ */
+int packer_iov(int channel_index, ring_buffer_size_t pos, ring_buffer_size_t max,
+               struct iovec *iov, int max_iov, ring_buffer_size_t *total);
+
+/**
+ * @brief 按协议栈实际接受的字节数推进客户端游标 (越过被剥离的分隔符)
+ */
+ring_buffer_size_t packer_advance(int channel_index, ring_buffer_size_t pos, ring_buffer_size_t accepted);
+
+/**
+ * @brief 丢弃所有客户端都已越过的帧记录
+ *
+ * @param slowest 最慢客户端的游标。
+ */
+void packer_release(int channel_index, ring_buffer_size_t slowest);
+
+/**
+ * @brief 串口接收侧: 端口即将读取新数据 (tSerialIO 或串口中断上下文)
+ * @details 距上次收到数据已达到字符间隔时，在 start 处记录一个帧边界。
+ * 应在新数据写入 buffer_uart 之前调用，保证网络调度任务先看到边界再看到数据。
+ *
+ * @param start 本批数据写入前的 head。
+ * @param clock 本周期的接收时钟 (逐周期累加的 sysTimestamp() 计数，不受计数器周期限制)。
+ */
+void packer_gap_rx(int channel_index, ring_buffer_size_t start, UINT32 clock);
+
+/**
+ * @brief 串口接收侧: 每个周期调用一次，线路空闲已达到字符间隔的通道在当前 head 处结束帧
+ */
+void packer_gap_poll(UINT32 clock);
+
+/**
+ * @brief 串口接收侧: 是否有收到数据后尚未因线路空闲结束的帧 (中断模式下定时器ISR据此决定是否唤醒 tSerialIO)
+ */
+BOOL packer_gap_pending(void);
+
+#endif /* APP_NET_PACKING_H_ */
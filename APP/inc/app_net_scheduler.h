@@ -3,6 +3,29 @@
 
 void NetworkSchedulerTask(void);
 
+// 唤醒网络调度任务 (可在中断上下文中调用，多次唤醒会合并为一次)
+void net_scheduler_wake(void);
+// 串口接收侧通知：buffer_uart 由 fill_before 增长后，按通道的打包阈值决定是否唤醒网络调度任务
+void net_scheduler_notify_rx(int channel_index, ring_buffer_size_t fill_before);
+// 串口发送侧通知：buffer_net 被取走数据后，恢复接收曾越过高水位而暂停、现已回落到低水位的通道
+void net_scheduler_notify_tx(int channel_index);
+// 把新的数据连接交给网络调度任务 (只由 ConnectionManagerTask 调用)，邮箱已满时返回 ERROR，由调用者关闭 fd
+STATUS net_scheduler_handoff(const NewConnectionMsg *msg);
+
+// Shell 调试接口：调度方式 (1: 事件驱动, 0: 固定 5ms 轮询) 与“串口就绪到网络发送”的延迟直方图
+void net_sched_mode_set(int event_driven);
+void net_latency_show(void);
+void net_latency_clear(void);
+// Shell 调试接口：未配置打包参数的通道的自适应批量 (批量字节数、等待时间与测得的到达速率)
+void net_batch_show(void);
+// Shell 调试接口：网络接收每轮的总字节预算与每通道服务统计 (字节数、获得配额次数、因预算用尽推迟的次数)
+void net_recv_budget_set(int bytes);
+void net_recv_show(void);
+
+// 通道环形缓冲区存储区的分配/归还 (仅在网络调度任务上下文中调用)
+STATUS channel_buffers_attach(int channel_index);
+void channel_buffers_detach(int channel_index);
+
 // 添加以下声明用于测试
 void NetSchedulerTestTask_Entry(void);
 
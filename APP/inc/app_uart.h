@@ -58,6 +58,8 @@
 int socket_send_to_middle(int sock_fd, char *buf, int buf_len);
 int init_usart(ChannelState *uart_instance, int client_socket, char *buf,int buf_len, int channel);
 int usart_set_baudrate(ChannelState *uart_instance, int client_socket,char *buf, int buf_len, int channel);
+void calculate_send_parameters(ChannelState* channel);
+void calculate_buffer_size(ChannelState* channel);
 void handle_command(ChannelState *uart_instance, int client_socket,char *buf, int buf_len, int channel);
 
 int usart_set_xon_xoff(int client_socket, int channel, char *buf, int buf_len);
@@ -69,6 +71,7 @@ int usart_set_start_break(int client_socket, int channel, char *buf, int buf_len
 int usart_set_stop_break(int client_socket, int channel, char *buf, int buf_len);
 int usart_report_queue(int client_socket, char *buf, int buf_len);
 int usart_close(int client_socket, char *buf, int buf_len);
+void usart_report_sw_overrun(int channel);
 
 void uart_task(unsigned int channel);
 void send_xon_xoff_char(uint8_t channel, uint8_t is_xon);
@@ -35,6 +35,30 @@ int axi16550Recv(unsigned int channel, uint8_t *buffer, uint32_t *len)
     return 0;
 }
 
+/* Read <known> bytes back to back without polling LSR (the caller knows the FIFO holds at
+ * least that many, e.g. from an RDA interrupt), then continue with LSR-checked reads */
+int axi16550RecvBurst(unsigned int channel, uint8_t *buffer, uint32_t known, uint32_t max, uint32_t *len)
+{
+    uint32_t i;
+
+    if (known > max)
+    {
+        known = max;
+    }
+    for (i = 0; i < known; i++)
+    {
+        buffer[i] = userAxiCfgRead(channel, AXI_16550_RBR);
+    }
+    *len = known;
+    while ((*len < max) && (userAxiCfgRead(channel, AXI_16550_LSR) & LSR_DR))
+    {
+        buffer[(*len)++] = userAxiCfgRead(channel, AXI_16550_RBR);
+    }
+    if (buffer == NULL || *len == 0)
+        return -1;
+    return 0;
+}
+
 int axi16550_TxReady(unsigned int channel)
 {
     if ((userAxiCfgRead(channel, AXI_16550_LSR) & LSR_THRE) == 0)
@@ -196,6 +220,42 @@ int axi16550FIFOInit(int port)
     return 0;
 }
 
+/* RX trigger level in bytes for each FCR[7:6] setting, scaled to the UART_HW_FIFO_SIZE FIFO
+ * the same way as 1/4/8/14 on a 16-byte FIFO */
+static const uint32_t s_rx_trigger_bytes[FCR_TRIGGER_LEVELS] = {
+    1, UART_HW_FIFO_SIZE / 4, UART_HW_FIFO_SIZE / 2, UART_HW_FIFO_SIZE * 7 / 8
+};
+
+/* Set the RX FIFO trigger level (0..3) without resetting the FIFOs */
+void axi16550RxTriggerSet(unsigned int channel, unsigned int level)
+{
+    if (level >= FCR_TRIGGER_LEVELS)
+    {
+        level = FCR_TRIGGER_LEVELS - 1;
+    }
+    userAxiCfgWrite(channel, AXI_16550_FCR, FCR_FIFO_ENABLE | (level << FCR_TRIGGER_SHIFT));
+}
+
+uint32_t axi16550RxTriggerBytes(unsigned int level)
+{
+    if (level >= FCR_TRIGGER_LEVELS)
+    {
+        level = FCR_TRIGGER_LEVELS - 1;
+    }
+    return s_rx_trigger_bytes[level];
+}
+
+void axi16550IntEnable(unsigned int channel, unsigned int ier)
+{
+    userAxiCfgWrite(channel, AXI_16550_IER, ier);
+}
+
+/* Reading IIR also clears a pending THRE interrupt */
+unsigned int axi16550IntId(unsigned int channel)
+{
+    return userAxiCfgRead(channel, AXI_16550_IIR);
+}
+
 
 /* LED control functions */
 void txled(int i, int action)
@@ -309,6 +369,34 @@ uint8_t UART_TX_FIFO_Ready(uint8_t channel)
     return check_bit(reg_value, 15 - channel);
 }
 
+/* The aggregated status words carry channel n at bit (15 - n); return them indexed by channel */
+static uint32_t uart_status_to_channel_mask(uint32_t reg_value)
+{
+    uint32_t mask = 0;
+    int ch;
+
+    for (ch = 0; ch < 16; ch++)
+    {
+        if (reg_value & BIT_MASK(15 - ch))
+        {
+            mask |= BIT_MASK(ch);
+        }
+    }
+    return mask;
+}
+
+/* Bit n set: channel n has at least one character in its RX FIFO (RXRDYn low at 0x30c) */
+uint32_t UART_RX_Ready_Mask(void)
+{
+    return uart_status_to_channel_mask(~(uint32_t)sysAxiReadLong(PL_AXI_BASE + 0x30c) & 0xFFFF);
+}
+
+/* Bit n set: channel n's TX FIFO is empty (TXRDYn low at 0x308) */
+uint32_t UART_TX_Empty_Mask(void)
+{
+    return uart_status_to_channel_mask(~(uint32_t)sysAxiReadLong(PL_AXI_BASE + 0x308) & 0xFFFF);
+}
+
 
 void UART_LSR_Print(uint8_t channel)
 {
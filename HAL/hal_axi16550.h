@@ -40,6 +40,26 @@
 #define LSR_THRE                  0x20  /* Transmitter Holding Register Empty (FIFO has space) */
 #define LSR_TEMT                  0x40  /* Transmitter Empty (FIFO and shift register empty) */
 
+/* Interrupt Enable Register (IER) bits */
+#define IER_RDA                   0x01  /* Received Data Available (incl. character timeout) */
+#define IER_THRE                  0x02  /* Transmitter Holding Register Empty */
+#define IER_RLS                   0x04  /* Receiver Line Status */
+#define IER_MS                    0x08  /* Modem Status */
+
+/* Interrupt Identification Register (IIR) */
+#define IIR_NO_INT                0x01  /* No interrupt pending */
+#define IIR_ID_MASK               0x0E
+#define IIR_ID_RLS                0x06  /* Receiver line status */
+#define IIR_ID_RDA                0x04  /* Received data reached trigger level */
+#define IIR_ID_TIMEOUT            0x0C  /* Character timeout, data below trigger level */
+#define IIR_ID_THRE               0x02  /* Transmitter holding register empty */
+#define IIR_ID_MS                 0x00  /* Modem status */
+
+/* FIFO Control Register (FCR) */
+#define FCR_FIFO_ENABLE           0x01
+#define FCR_TRIGGER_SHIFT         6
+#define FCR_TRIGGER_LEVELS        4     /* RX trigger level index 0..3 */
+
 /* XON/XOFF control characters */
 #define XON_CHAR                  0x11  /* XON �ַ���DC1��*/
 #define XOFF_CHAR                 0x13  /* XOFF �ַ���DC3��*/
@@ -64,6 +84,7 @@ typedef struct usart_info
 void userAxiCfgWrite(unsigned int channel, unsigned int offset, unsigned int data);
 unsigned int userAxiCfgRead(unsigned int channel, unsigned int offset);
 int axi16550Recv(unsigned int channel, uint8_t *buffer, uint32_t *len);
+int axi16550RecvBurst(unsigned int channel, uint8_t *buffer, uint32_t known, uint32_t max, uint32_t *len);
 int axi16550_TxReady(unsigned int channel);
 int axi16550SendNoWait(unsigned int channel, uint8_t *buffer, uint32_t len);
 int axi16550Send(unsigned int channel, uint8_t *buffer, uint32_t len);
@@ -72,8 +93,15 @@ void axi16550SendStartBreak(unsigned int channel);
 void axi16550SendStopBreak(unsigned int channel);
 void send_xon_xoff_char(uint8_t channel, uint8_t is_xon);
 void axi16550Init(unsigned int channel, unsigned int baud);
+void axi16550RxTriggerSet(unsigned int channel, unsigned int level);
+uint32_t axi16550RxTriggerBytes(unsigned int level);
+void axi16550IntEnable(unsigned int channel, unsigned int ier);
+unsigned int axi16550IntId(unsigned int channel);
 void axi165502CInit(usart_info_t *uart_instance, int channel);
 void txled(int i, int action);
 void rxled(int i, int action);
 void Portled(int i, int action);
+uint8_t UART_TX_FIFO_Ready(uint8_t channel);
+uint32_t UART_RX_Ready_Mask(void);
+uint32_t UART_TX_Empty_Mask(void);
 #endif /* AXI_16550_H_ */
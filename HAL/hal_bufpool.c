@@ -0,0 +1,183 @@
+/*
+ * =====================================================================================
+ *
+ * Filename:  hal_bufpool.c
+ *
+ * Description:  实现通道环形缓冲区使用的缓冲池 (伙伴算法)。
+ * 块大小为 BUF_POOL_MIN_BLOCK ~ BUF_POOL_MAX_BLOCK 之间的2的幂，
+ * 释放时与空闲的伙伴块合并，长期运行不会产生碎片。
+ *
+ * =====================================================================================
+ */
+
+#include "hal_bufpool.h"
+#include "hal_log.h"
+#include <semLib.h>
+#include <string.h>
+
+/* ------------------ Internal Constants ------------------ */
+#define BUF_POOL_NUM_ORDERS  (BUF_POOL_MAX_ORDER - BUF_POOL_MIN_ORDER + 1)
+#define BUF_POOL_NUM_UNITS   (BUF_POOL_SIZE / BUF_POOL_MIN_BLOCK)     // 以最小块为单位的总数
+
+/* ------------------ Internal Data Structures ------------------ */
+// 空闲链表节点，直接存放在空闲块自身的内存中
+typedef struct BufPoolFreeBlock {
+    struct BufPoolFreeBlock *next;
+} BufPoolFreeBlock;
+
+/* ------------------ Module-level static variables ------------------ */
+static char s_pool_mem[BUF_POOL_SIZE] __attribute__((aligned(64)));
+static BufPoolFreeBlock *s_free_list[BUF_POOL_NUM_ORDERS];    // 每一阶的空闲链表
+static unsigned char s_free_order[BUF_POOL_NUM_UNITS];        // 空闲块首单元: 阶数+1，否则为0
+static unsigned char s_used_order[BUF_POOL_NUM_UNITS];        // 已分配块首单元: 阶数+1，否则为0
+static size_t s_free_bytes;
+static SEM_ID s_pool_mutex;
+
+/* ------------------ Private Functions ------------------ */
+
+static void *unit_to_block(int unit)
+{
+    return s_pool_mem + ((size_t)unit << BUF_POOL_MIN_ORDER);
+}
+
+static int block_to_unit(void *block)
+{
+    return (int)(((char*)block - s_pool_mem) >> BUF_POOL_MIN_ORDER);
+}
+
+static void push_free(int unit, int order)
+{
+    BufPoolFreeBlock *block = (BufPoolFreeBlock*)unit_to_block(unit);
+    block->next = s_free_list[order];
+    s_free_list[order] = block;
+    s_free_order[unit] = order + 1;
+}
+
+static int pop_free(int order)
+{
+    BufPoolFreeBlock *block = s_free_list[order];
+    int unit = block_to_unit(block);
+    s_free_list[order] = block->next;
+    s_free_order[unit] = 0;
+    return unit;
+}
+
+static void remove_free(int unit, int order)
+{
+    BufPoolFreeBlock **pp = &s_free_list[order];
+    BufPoolFreeBlock *block = (BufPoolFreeBlock*)unit_to_block(unit);
+
+    while (*pp != block) {
+        pp = &(*pp)->next;
+    }
+    *pp = block->next;
+    s_free_order[unit] = 0;
+}
+
+/* ------------------ Public API Implementations ------------------ */
+
+int buf_pool_init(void)
+{
+    int unit;
+
+    if (s_pool_mutex != NULL) {
+        return OK; // 已初始化
+    }
+
+    s_pool_mutex = semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+    if (s_pool_mutex == NULL) {
+        LOG_ERROR("FATAL: Failed to create buffer pool mutex.\n");
+        return ERROR;
+    }
+
+    memset(s_free_list, 0, sizeof(s_free_list));
+    memset(s_free_order, 0, sizeof(s_free_order));
+    memset(s_used_order, 0, sizeof(s_used_order));
+
+    // 整个缓冲池初始为若干个最大块
+    for (unit = 0; unit < BUF_POOL_NUM_UNITS; unit += (1 << (BUF_POOL_NUM_ORDERS - 1))) {
+        push_free(unit, BUF_POOL_NUM_ORDERS - 1);
+    }
+    s_free_bytes = BUF_POOL_SIZE;
+
+    LOG_INFO("Buffer pool initialized: %d KB, blocks %u ~ %u bytes.\n",
+             BUF_POOL_SIZE / 1024, BUF_POOL_MIN_BLOCK, BUF_POOL_MAX_BLOCK);
+    return OK;
+}
+
+void *buf_pool_alloc(size_t size)
+{
+    int order = 0;
+    int avail;
+    int unit;
+
+    while (((size_t)BUF_POOL_MIN_BLOCK << order) < size) {
+        order++;
+    }
+    if (order >= BUF_POOL_NUM_ORDERS) {
+        return NULL;
+    }
+
+    semTake(s_pool_mutex, WAIT_FOREVER);
+
+    // 找到能满足请求的最小空闲块
+    for (avail = order; avail < BUF_POOL_NUM_ORDERS && s_free_list[avail] == NULL; avail++) {
+    }
+    if (avail == BUF_POOL_NUM_ORDERS) {
+        semGive(s_pool_mutex);
+        return NULL;
+    }
+
+    // 逐级拆分，多出的后半块挂回空闲链表
+    unit = pop_free(avail);
+    while (avail > order) {
+        avail--;
+        push_free(unit + (1 << avail), avail);
+    }
+    s_used_order[unit] = order + 1;
+    s_free_bytes -= (size_t)BUF_POOL_MIN_BLOCK << order;
+
+    semGive(s_pool_mutex);
+    return unit_to_block(unit);
+}
+
+void buf_pool_free(void *ptr)
+{
+    int unit;
+    int order;
+
+    if (ptr == NULL) {
+        return;
+    }
+
+    unit = block_to_unit(ptr);
+    if ((char*)ptr < s_pool_mem || unit >= BUF_POOL_NUM_UNITS || s_used_order[unit] == 0) {
+        LOG_ERROR("buf_pool_free: %p is not an allocated pool block.\n", ptr);
+        return;
+    }
+
+    semTake(s_pool_mutex, WAIT_FOREVER);
+
+    order = s_used_order[unit] - 1;
+    s_used_order[unit] = 0;
+    s_free_bytes += (size_t)BUF_POOL_MIN_BLOCK << order;
+
+    // 伙伴块也空闲时合并为上一阶
+    while (order < BUF_POOL_NUM_ORDERS - 1) {
+        int buddy = unit ^ (1 << order);
+        if (s_free_order[buddy] != order + 1) {
+            break;
+        }
+        remove_free(buddy, order);
+        unit &= ~(1 << order);
+        order++;
+    }
+    push_free(unit, order);
+
+    semGive(s_pool_mutex);
+}
+
+size_t buf_pool_free_bytes(void)
+{
+    return s_free_bytes;
+}
@@ -0,0 +1,53 @@
+#ifndef HAL_BUFPOOL_H
+#define HAL_BUFPOOL_H
+
+#include <vxWorks.h>
+#include <stddef.h>
+
+/* ------------------ Pool Geometry ------------------ */
+#define BUF_POOL_MIN_ORDER   12                          // 最小块 4KB
+#define BUF_POOL_MAX_ORDER   19                          // 最大块 512KB
+#define BUF_POOL_MIN_BLOCK   (1u << BUF_POOL_MIN_ORDER)
+#define BUF_POOL_MAX_BLOCK   (1u << BUF_POOL_MAX_ORDER)
+
+#ifndef BUF_POOL_SIZE
+#define BUF_POOL_SIZE        (4 * 1024 * 1024)           // 缓冲池总大小，必须是 BUF_POOL_MAX_BLOCK 的整数倍
+#endif
+
+/* ------------------ Public API Functions ------------------ */
+
+/**
+ * @brief 初始化缓冲池
+ * @details 缓冲池按伙伴算法管理一块静态内存，分配出的块大小均为2的幂，
+ * 且起始地址按cache行对齐，可直接用作 ring_buffer_t 的存储区。
+ * 应在任何通道分配缓冲区之前调用一次。
+ *
+ * @return int OK on success, ERROR on failure.
+ */
+int buf_pool_init(void);
+
+/**
+ * @brief 从缓冲池分配一块内存
+ * @details 请求大小向上取整为2的幂 (不小于 BUF_POOL_MIN_BLOCK)。
+ * 不可在中断上下文中调用。
+ *
+ * @param size 请求的字节数 (不大于 BUF_POOL_MAX_BLOCK)。
+ * @return void* 内存块地址；缓冲池耗尽或 size 过大时返回 NULL。
+ */
+void *buf_pool_alloc(size_t size);
+
+/**
+ * @brief 将内存块归还缓冲池，并与空闲的伙伴块合并
+ *
+ * @param ptr buf_pool_alloc() 返回的地址 (NULL 时不做任何事)。
+ */
+void buf_pool_free(void *ptr);
+
+/**
+ * @brief 获取缓冲池当前的空闲字节数
+ *
+ * @return size_t 空闲字节数 (可能分散在多个块中)。
+ */
+size_t buf_pool_free_bytes(void);
+
+#endif /* HAL_BUFPOOL_H */
@@ -0,0 +1,233 @@
+/*
+ * =====================================================================================
+ *
+ * Filename:  hal_pollset.c
+ *
+ * Description:  实现网络调度任务使用的持久就绪集合。
+ * fd 只在登记/注销时进入或离开集合，每次等待只需一次系统调用，
+ * 就绪的 fd 连同调用者的标识一起返回，无需再逐个比对。
+ *
+ * =====================================================================================
+ */
+
+#include "hal_pollset.h"
+#include <string.h>
+
+#ifdef __linux__
+/* ------------------ 主机实现: epoll ------------------ */
+#include <sys/epoll.h>
+#include <unistd.h>
+
+static int s_epoll_fd = -1;
+
+static uint32_t to_epoll_events(uint32_t events)
+{
+    return ((events & POLL_SET_IN) ? EPOLLIN : 0) | ((events & POLL_SET_OUT) ? EPOLLOUT : 0);
+}
+
+static int epoll_update(int op, int fd, uint32_t events, uint32_t tag)
+{
+    struct epoll_event ev;
+
+    ev.events = to_epoll_events(events);
+    // fd 与 tag 一起放进 64 位的用户数据，返回时无需查表
+    ev.data.u64 = ((uint64_t)(uint32_t)fd << 32) | tag;
+    return (epoll_ctl(s_epoll_fd, op, fd, &ev) == 0) ? OK : ERROR;
+}
+
+int poll_set_init(void)
+{
+    if (s_epoll_fd < 0) {
+        s_epoll_fd = epoll_create1(0);
+    }
+    return (s_epoll_fd < 0) ? ERROR : OK;
+}
+
+int poll_set_add(int fd, uint32_t events, uint32_t tag)
+{
+    return epoll_update(EPOLL_CTL_ADD, fd, events, tag);
+}
+
+int poll_set_modify(int fd, uint32_t events, uint32_t tag)
+{
+    return epoll_update(EPOLL_CTL_MOD, fd, events, tag);
+}
+
+int poll_set_remove(int fd)
+{
+    struct epoll_event ev;
+
+    return (epoll_ctl(s_epoll_fd, EPOLL_CTL_DEL, fd, &ev) == 0) ? OK : ERROR;
+}
+
+int poll_set_wait(poll_event_t *out, int max_events, int timeout_ms)
+{
+    struct epoll_event evs[POLL_SET_MAX_FDS];
+    int n, k;
+
+    if (max_events > POLL_SET_MAX_FDS) {
+        max_events = POLL_SET_MAX_FDS;
+    }
+    n = epoll_wait(s_epoll_fd, evs, max_events, timeout_ms);
+    if (n < 0) {
+        return ERROR;
+    }
+    for (k = 0; k < n; k++) {
+        out[k].fd = (int)(evs[k].data.u64 >> 32);
+        out[k].tag = (uint32_t)evs[k].data.u64;
+        out[k].events = ((evs[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) ? POLL_SET_IN : 0)
+                      | ((evs[k].events & EPOLLOUT) ? POLL_SET_OUT : 0);
+    }
+    return n;
+}
+
+#else
+/* ------------------ VxWorks 实现: 持久 fd_set + select() ------------------ */
+#include <selectLib.h>
+
+static fd_set s_read_set;                       // 登记时维护，等待时整体复制
+static fd_set s_write_set;
+static int s_fds[POLL_SET_MAX_FDS];             // 已登记的 fd，紧凑存放
+static uint32_t s_events[POLL_SET_MAX_FDS];
+static uint32_t s_tags[POLL_SET_MAX_FDS];
+static int s_count;
+static int s_max_fd = -1;
+static int s_write_count;                       // 关注可写的 fd 数，为0时不传写集合
+
+static int find_slot(int fd)
+{
+    int k;
+
+    for (k = 0; k < s_count; k++) {
+        if (s_fds[k] == fd) {
+            return k;
+        }
+    }
+    return ERROR;
+}
+
+static void apply_events(int fd, uint32_t old_events, uint32_t events)
+{
+    if (events & POLL_SET_IN) {
+        FD_SET(fd, &s_read_set);
+    } else {
+        FD_CLR(fd, &s_read_set);
+    }
+    if (events & POLL_SET_OUT) {
+        FD_SET(fd, &s_write_set);
+    } else {
+        FD_CLR(fd, &s_write_set);
+    }
+    s_write_count += ((events & POLL_SET_OUT) ? 1 : 0) - ((old_events & POLL_SET_OUT) ? 1 : 0);
+}
+
+int poll_set_init(void)
+{
+    FD_ZERO(&s_read_set);
+    FD_ZERO(&s_write_set);
+    s_count = 0;
+    s_max_fd = -1;
+    s_write_count = 0;
+    return OK;
+}
+
+int poll_set_add(int fd, uint32_t events, uint32_t tag)
+{
+    if (fd < 0 || fd >= FD_SETSIZE || s_count >= POLL_SET_MAX_FDS || find_slot(fd) != ERROR) {
+        return ERROR;
+    }
+    s_fds[s_count] = fd;
+    s_events[s_count] = events;
+    s_tags[s_count] = tag;
+    s_count++;
+    apply_events(fd, 0, events);
+    if (fd > s_max_fd) {
+        s_max_fd = fd;
+    }
+    return OK;
+}
+
+int poll_set_modify(int fd, uint32_t events, uint32_t tag)
+{
+    int k = find_slot(fd);
+
+    if (k == ERROR) {
+        return ERROR;
+    }
+    apply_events(fd, s_events[k], events);
+    s_events[k] = events;
+    s_tags[k] = tag;
+    return OK;
+}
+
+int poll_set_remove(int fd)
+{
+    int k = find_slot(fd);
+
+    if (k == ERROR) {
+        return ERROR;
+    }
+    apply_events(fd, s_events[k], 0);
+    s_count--;
+    s_fds[k] = s_fds[s_count];
+    s_events[k] = s_events[s_count];
+    s_tags[k] = s_tags[s_count];
+
+    if (fd == s_max_fd) {
+        s_max_fd = -1;
+        for (k = 0; k < s_count; k++) {
+            if (s_fds[k] > s_max_fd) {
+                s_max_fd = s_fds[k];
+            }
+        }
+    }
+    return OK;
+}
+
+int poll_set_wait(poll_event_t *out, int max_events, int timeout_ms)
+{
+    fd_set readfds;
+    fd_set writefds;
+    struct timeval timeout;
+    int ret, k, n = 0;
+
+    if (s_count == 0 && timeout_ms == 0) {
+        return 0;
+    }
+    memcpy(&readfds, &s_read_set, sizeof(fd_set));
+    if (s_write_count > 0) {
+        memcpy(&writefds, &s_write_set, sizeof(fd_set));
+    }
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_usec = (timeout_ms % 1000) * 1000;
+
+    ret = select(s_max_fd + 1, &readfds, (s_write_count > 0) ? &writefds : NULL, NULL,
+                 (timeout_ms < 0) ? NULL : &timeout);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    // 只扫描已登记的 fd，就绪数达到 select() 的返回值即可提前结束
+    for (k = 0; k < s_count && n < max_events && ret > 0; k++) {
+        int fd = s_fds[k];
+        uint32_t events = 0;
+
+        if ((s_events[k] & POLL_SET_IN) && FD_ISSET(fd, &readfds)) {
+            events |= POLL_SET_IN;
+            ret--;
+        }
+        if ((s_events[k] & POLL_SET_OUT) && s_write_count > 0 && FD_ISSET(fd, &writefds)) {
+            events |= POLL_SET_OUT;
+            ret--;
+        }
+        if (events) {
+            out[n].fd = fd;
+            out[n].events = events;
+            out[n].tag = s_tags[k];
+            n++;
+        }
+    }
+    return n;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,70 @@
+#ifndef HAL_POLLSET_H
+#define HAL_POLLSET_H
+
+#include <vxWorks.h>
+#include <stdint.h>
+
+/* ------------------ Interest Flags ------------------ */
+#define POLL_SET_IN          0x1u                        // 可读
+#define POLL_SET_OUT         0x2u                        // 可写
+
+#ifndef POLL_SET_MAX_FDS
+#define POLL_SET_MAX_FDS     (160)                       // 16通道 x 8客户端，另留出管道等内部 fd
+#endif
+
+/**
+ * @brief poll_set_wait() 返回的一个就绪事件
+ */
+typedef struct {
+    int      fd;
+    uint32_t events;                                     // POLL_SET_IN / POLL_SET_OUT
+    uint32_t tag;                                        // 登记时由调用者指定，原样返回
+} poll_event_t;
+
+/* ------------------ Public API Functions ------------------ */
+
+/**
+ * @brief 初始化全局就绪集合
+ * @details 集合在 fd 登记/注销时更新，等待时不再逐个重建 fd_set。
+ * VxWorks 上以持久的 fd_set 副本加 select() 实现；Linux 主机上以 epoll 实现，
+ * 便于在主机上用大量 socketpair 做基准测试。只应由一个任务使用。
+ *
+ * @return int OK on success, ERROR on failure.
+ */
+int poll_set_init(void);
+
+/**
+ * @brief 登记一个 fd
+ *
+ * @param fd 文件描述符。
+ * @param events 关注的事件 (POLL_SET_IN / POLL_SET_OUT 的组合)。
+ * @param tag 调用者自定义的标识 (例如通道号与客户端槽位)，随事件返回。
+ * @return int OK on success, ERROR 表示集合已满或 fd 已登记。
+ */
+int poll_set_add(int fd, uint32_t events, uint32_t tag);
+
+/**
+ * @brief 修改已登记 fd 关注的事件和标识
+ *
+ * @return int OK on success, ERROR 表示 fd 未登记。
+ */
+int poll_set_modify(int fd, uint32_t events, uint32_t tag);
+
+/**
+ * @brief 注销一个 fd，应在 close() 之前调用
+ *
+ * @return int OK on success, ERROR 表示 fd 未登记。
+ */
+int poll_set_remove(int fd);
+
+/**
+ * @brief 等待已登记的 fd 就绪
+ *
+ * @param out 就绪事件输出数组。
+ * @param max_events out 的容量。
+ * @param timeout_ms 最长等待时间 (毫秒)，0 表示立即返回，负数表示一直等待。
+ * @return int 就绪事件数 (超时为0)，出错时返回 ERROR。
+ */
+int poll_set_wait(poll_event_t *out, int max_events, int timeout_ms);
+
+#endif /* HAL_POLLSET_H */
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "hal_ringbuffer.h"
 
 /**
@@ -5,6 +6,48 @@
  * Implementation of ring buffer functions.
  */
 
+/* Copies <size> bytes into the buffer at free-running index <pos>, as at most two segments */
+static void ring_buffer_copy_in(ring_buffer_t *buffer, ring_buffer_size_t pos, const char *data, ring_buffer_size_t size)
+{
+    ring_buffer_size_t offset = (pos & RING_BUFFER_MASK(buffer));
+    ring_buffer_size_t first = RING_BUFFER_CAPACITY(buffer) - offset;
+
+    if (first > size)
+    {
+        first = size;
+    }
+    memcpy(&buffer->buffer[offset], data, first);
+    memcpy(buffer->buffer, data + first, size - first);
+}
+
+/* Copies <size> bytes out of the buffer from free-running index <pos>, as at most two segments */
+static void ring_buffer_copy_out(ring_buffer_t *buffer, ring_buffer_size_t pos, char *data, ring_buffer_size_t size)
+{
+    ring_buffer_size_t offset = (pos & RING_BUFFER_MASK(buffer));
+    ring_buffer_size_t first = RING_BUFFER_CAPACITY(buffer) - offset;
+
+    if (first > size)
+    {
+        first = size;
+    }
+    memcpy(data, &buffer->buffer[offset], first);
+    memcpy(data + first, buffer->buffer, size - first);
+}
+
+/* Moves the tail from <tail> to <tail + len>, unless the producer already overwrote past it */
+static void ring_buffer_advance_tail(ring_buffer_t *buffer, ring_buffer_size_t tail, ring_buffer_size_t len)
+{
+    ring_buffer_size_t expected = tail;
+
+    while (!RING_BUFFER_CAS(&buffer->tail_index, &expected, tail + len))
+    {
+        if ((ring_buffer_size_t)(expected - tail) >= len)
+        {
+            return;
+        }
+    }
+}
+
 void ring_buffer_init(ring_buffer_t *buffer, char *buf, size_t buf_size)
 {
     RING_BUFFER_ASSERT(RING_BUFFER_IS_POWER_OF_TWO(buf_size) == 1);
@@ -12,6 +55,7 @@ void ring_buffer_init(ring_buffer_t *buffer, char *buf, size_t buf_size)
     buffer->buffer_mask = buf_size - 1;
     buffer->tail_index = 0;
     buffer->head_index = 0;
+    buffer->peek_index = 0;
 }
 
 void ring_buffer_queue(ring_buffer_t *buffer, char data)
@@ -21,21 +65,39 @@ void ring_buffer_queue(ring_buffer_t *buffer, char data)
     {
         /* Is going to overwrite the oldest byte */
         /* Increase tail index */
-        buffer->tail_index = ((buffer->tail_index + 1) & RING_BUFFER_MASK(buffer));
+        buffer->tail_index++;
     }
 
     /* Place data in buffer */
-    buffer->buffer[buffer->head_index] = data;
-    buffer->head_index = ((buffer->head_index + 1) & RING_BUFFER_MASK(buffer));
+    buffer->buffer[buffer->head_index & RING_BUFFER_MASK(buffer)] = data;
+    buffer->head_index++;
 }
 
 void ring_buffer_queue_arr(ring_buffer_t *buffer, const char *data, ring_buffer_size_t size)
 {
-    /* Add bytes; one by one */
-    ring_buffer_size_t i;
-    for (i = 0; i < size; i++)
+    ring_buffer_size_t capacity = RING_BUFFER_CAPACITY(buffer);
+    ring_buffer_size_t free_space;
+
+    if (size == 0)
+    {
+        return;
+    }
+
+    /* Only the newest <capacity> bytes can survive; skip the rest */
+    if (size > capacity)
+    {
+        data += size - capacity;
+        size = capacity;
+    }
+    free_space = capacity - ring_buffer_num_items(buffer);
+
+    ring_buffer_copy_in(buffer, buffer->head_index, data, size);
+    buffer->head_index += size;
+
+    if (size > free_space)
     {
-        ring_buffer_queue(buffer, data[i]);
+        /* Overwrote the oldest bytes, buffer is now exactly full */
+        buffer->tail_index = buffer->head_index - capacity;
     }
 }
 
@@ -47,29 +109,169 @@ uint8_t ring_buffer_dequeue(ring_buffer_t *buffer, char *data)
         return 0;
     }
 
-    *data = buffer->buffer[buffer->tail_index];
-    buffer->tail_index = ((buffer->tail_index + 1) & RING_BUFFER_MASK(buffer));
+    *data = buffer->buffer[buffer->tail_index & RING_BUFFER_MASK(buffer)];
+    buffer->tail_index++;
     return 1;
 }
 
 ring_buffer_size_t ring_buffer_dequeue_arr(ring_buffer_t *buffer, char *data, ring_buffer_size_t len)
 {
-    if (ring_buffer_is_empty(buffer))
+    ring_buffer_size_t cnt = ring_buffer_num_items(buffer);
+
+    if (cnt == 0)
     {
         /* No items */
         return 0;
     }
-
-    char *data_ptr = data;
-    ring_buffer_size_t cnt = 0;
-    while ((cnt < len) && ring_buffer_dequeue(buffer, data_ptr))
+    if (cnt > len)
     {
-        cnt++;
-        data_ptr++;
+        cnt = len;
     }
+
+    ring_buffer_copy_out(buffer, buffer->tail_index, data, cnt);
+    buffer->tail_index += cnt;
     return cnt;
 }
 
+ring_buffer_size_t ring_buffer_spsc_queue_arr(ring_buffer_t *buffer, const char *data, ring_buffer_size_t size)
+{
+    /* head is ours; tail is owned by the consumer and only read here */
+    ring_buffer_size_t head = RING_BUFFER_LOAD_RELAXED(&buffer->head_index);
+    ring_buffer_size_t tail = RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index);
+    ring_buffer_size_t free_space = RING_BUFFER_CAPACITY(buffer) - (head - tail);
+
+    if (size > free_space)
+    {
+        size = free_space;
+    }
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    ring_buffer_copy_in(buffer, head, data, size);
+    /* Publish the bytes only after they are in place */
+    RING_BUFFER_STORE_RELEASE(&buffer->head_index, head + size);
+    return size;
+}
+
+ring_buffer_size_t ring_buffer_spsc_overwrite_arr(ring_buffer_t *buffer, const char *data, ring_buffer_size_t size)
+{
+    ring_buffer_size_t capacity = RING_BUFFER_CAPACITY(buffer);
+    ring_buffer_size_t head = RING_BUFFER_LOAD_RELAXED(&buffer->head_index);
+    ring_buffer_size_t tail = RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index);
+    ring_buffer_size_t lost = 0;
+
+    /* Only the newest <capacity> bytes can survive; skip the rest */
+    if (size > capacity)
+    {
+        lost = size - capacity;
+        data += lost;
+        size = capacity;
+    }
+
+    /* Push the tail past the oldest bytes; a failed CAS reloads tail */
+    while (capacity - (head - tail) < size)
+    {
+        ring_buffer_size_t new_tail = head + size - capacity;
+
+        if (RING_BUFFER_CAS(&buffer->tail_index, &tail, new_tail))
+        {
+            lost += new_tail - tail;
+            break;
+        }
+    }
+
+    ring_buffer_copy_in(buffer, head, data, size);
+    RING_BUFFER_STORE_RELEASE(&buffer->head_index, head + size);
+    return lost;
+}
+
+ring_buffer_size_t ring_buffer_reserve(ring_buffer_t *buffer, char **span)
+{
+    ring_buffer_size_t head = RING_BUFFER_LOAD_RELAXED(&buffer->head_index);
+    ring_buffer_size_t tail = RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index);
+    ring_buffer_size_t offset = (head & RING_BUFFER_MASK(buffer));
+    ring_buffer_size_t len = RING_BUFFER_CAPACITY(buffer) - (head - tail);
+
+    /* Stop at the physical end; the rest is reserved by the next call */
+    if (len > RING_BUFFER_CAPACITY(buffer) - offset)
+    {
+        len = RING_BUFFER_CAPACITY(buffer) - offset;
+    }
+    *span = &buffer->buffer[offset];
+    return len;
+}
+
+void ring_buffer_commit(ring_buffer_t *buffer, ring_buffer_size_t len)
+{
+    ring_buffer_size_t head = RING_BUFFER_LOAD_RELAXED(&buffer->head_index);
+
+    RING_BUFFER_ASSERT(len <= ring_buffer_num_free(buffer));
+    RING_BUFFER_STORE_RELEASE(&buffer->head_index, head + len);
+}
+
+ring_buffer_size_t ring_buffer_peek_span(ring_buffer_t *buffer, char **span)
+{
+    ring_buffer_size_t tail = RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index);
+    ring_buffer_size_t head = RING_BUFFER_LOAD_ACQUIRE(&buffer->head_index);
+    ring_buffer_size_t offset = (tail & RING_BUFFER_MASK(buffer));
+    ring_buffer_size_t len = head - tail;
+
+    buffer->peek_index = tail;
+    /* Stop at the physical end; the rest is returned by the next call */
+    if (len > RING_BUFFER_CAPACITY(buffer) - offset)
+    {
+        len = RING_BUFFER_CAPACITY(buffer) - offset;
+    }
+    *span = &buffer->buffer[offset];
+    return len;
+}
+
+void ring_buffer_consume(ring_buffer_t *buffer, ring_buffer_size_t len)
+{
+    /* Relative to the peeked tail: an overwriting producer may have moved it since */
+    RING_BUFFER_ASSERT(len <= RING_BUFFER_CAPACITY(buffer));
+    ring_buffer_advance_tail(buffer, buffer->peek_index, len);
+    buffer->peek_index += len;
+}
+
+ring_buffer_size_t ring_buffer_peek_spans_at(ring_buffer_t *buffer, ring_buffer_size_t index, ring_buffer_size_t len,
+                                             char *span[2], ring_buffer_size_t span_len[2])
+{
+    ring_buffer_size_t head = RING_BUFFER_LOAD_ACQUIRE(&buffer->head_index);
+    ring_buffer_size_t offset = (index & RING_BUFFER_MASK(buffer));
+    ring_buffer_size_t first = RING_BUFFER_CAPACITY(buffer) - offset;
+
+    RING_BUFFER_ASSERT((ring_buffer_size_t)(head - index) <= RING_BUFFER_CAPACITY(buffer));
+    if (len > head - index)
+    {
+        len = head - index;
+    }
+    if (first > len)
+    {
+        first = len;
+    }
+    /* The second segment, if any, always starts at the beginning of the storage */
+    span[0] = &buffer->buffer[offset];
+    span_len[0] = first;
+    span[1] = buffer->buffer;
+    span_len[1] = len - first;
+    return len;
+}
+
+void ring_buffer_release_to(ring_buffer_t *buffer, ring_buffer_size_t index)
+{
+    ring_buffer_size_t tail = RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index);
+
+    if ((ring_buffer_size_t)(index - tail) > RING_BUFFER_CAPACITY(buffer))
+    {
+        /* Behind the tail: an overwriting producer already released it */
+        return;
+    }
+    ring_buffer_advance_tail(buffer, tail, index - tail);
+}
+
 uint8_t ring_buffer_peek(ring_buffer_t *buffer, char *data, ring_buffer_size_t index)
 {
     if (index >= ring_buffer_num_items(buffer))
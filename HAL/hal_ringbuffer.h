@@ -18,8 +18,6 @@ extern "C"
 
 /**
  * Checks if the buffer_size is a power of two.
- * Due to the design only <tt> RING_BUFFER_SIZE-1 </tt> items
- * can be contained in the buffer.
  * buffer_size must be a power of two.
 */
 #define RING_BUFFER_IS_POWER_OF_TWO(buffer_size) ((buffer_size & (buffer_size - 1)) == 0)
@@ -36,7 +34,33 @@ typedef size_t ring_buffer_size_t;
  * where \c a is a positive index in the buffer and
  * \c b is the (power of two) size of the buffer.
  */
-#define RING_BUFFER_MASK(rb) (rb->buffer_mask)
+#define RING_BUFFER_MASK(rb) ((rb)->buffer_mask)
+
+/**
+ * Number of bytes the buffer can hold.
+ * Head and tail are free-running counters, so all
+ * <tt> buf_size </tt> bytes are usable.
+ */
+#define RING_BUFFER_CAPACITY(rb) (RING_BUFFER_MASK(rb) + 1)
+
+/**
+ * Ordered accessors for the indices shared by producer and consumer.
+ * The producer publishes bytes with a release store of \c head_index,
+ * the consumer hands slots back with a release store of \c tail_index.
+ * Each side reads the other side's index with an acquire load.
+ */
+#define RING_BUFFER_LOAD_RELAXED(p)      __atomic_load_n((p), __ATOMIC_RELAXED)
+#define RING_BUFFER_LOAD_ACQUIRE(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_BUFFER_STORE_RELEASE(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+/**
+ * Compare-and-swap of an index. Only \c tail_index is ever swapped:
+ * ring_buffer_spsc_overwrite_arr() lets the producer push it forward,
+ * so the consumer must not blindly store over it.
+ * On failure <tt>*expected</tt> is updated with the current value.
+ */
+#define RING_BUFFER_CAS(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
 
 /**
  * Simplifies the use of <tt>struct ring_buffer_t</tt>.
@@ -54,16 +78,20 @@ struct ring_buffer_t
     char *buffer;
     /** Buffer mask. */
     ring_buffer_size_t buffer_mask;
-    /** Index of tail. */
+    /** Free-running index of tail. Written by the consumer, and by the
+     *  producer only through ring_buffer_spsc_overwrite_arr(). */
     ring_buffer_size_t tail_index;
-    /** Index of head. */
+    /** Free-running index of head. Written by the producer only. */
     ring_buffer_size_t head_index;
+    /** Tail seen by the last ring_buffer_peek_span(). Consumer-private. */
+    ring_buffer_size_t peek_index;
 };
 
 /**
  * Initializes the ring buffer pointed to by <em>buffer</em>.
- * This function can also be used to empty/reset the buffer.
- * The resulting buffer can contain <em>buf_size-1</em> bytes.
+ * This function can also be used to empty/reset the buffer, as long as
+ * neither the producer nor the consumer is using it at the same time.
+ * The resulting buffer can contain <em>buf_size</em> bytes.
  * @param buffer The ring buffer to initialize.
  * @param buf The buffer allocated for the ringbuffer.
  * @param buf_size The size of the allocated ringbuffer.
@@ -72,6 +100,9 @@ void ring_buffer_init(ring_buffer_t *buffer, char *buf, size_t buf_size);
 
 /**
  * Adds a byte to a ring buffer.
+ * If the buffer is full the oldest byte is overwritten, which moves the
+ * tail from the producer side: only use this when producer and consumer
+ * run in the same context. See ring_buffer_spsc_queue_arr() otherwise.
  * @param buffer The buffer in which the data should be placed.
  * @param data The byte to place.
  */
@@ -79,6 +110,9 @@ void ring_buffer_queue(ring_buffer_t *buffer, char data);
 
 /**
  * Adds an array of bytes to a ring buffer.
+ * The data is copied as at most two contiguous segments. If it does not
+ * fit, the oldest bytes are overwritten, same as repeated ring_buffer_queue().
+ * Same context restriction as ring_buffer_queue().
  * @param buffer The buffer in which the data should be placed.
  * @param data A pointer to the array of bytes to place in the queue.
  * @param size The size of the array.
@@ -95,6 +129,7 @@ uint8_t ring_buffer_dequeue(ring_buffer_t *buffer, char *data);
 
 /**
  * Returns the <em>len</em> oldest bytes in a ring buffer.
+ * The data is copied as at most two contiguous segments.
  * @param buffer The buffer from which the data should be returned.
  * @param data A pointer to the array at which the data should be placed.
  * @param len The maximum number of bytes to return.
@@ -112,23 +147,128 @@ uint8_t ring_buffer_peek(ring_buffer_t *buffer, char *data, ring_buffer_size_t i
 
 
 /**
- * Returns whether a ring buffer is empty.
- * @param buffer The buffer for which it should be returned whether it is empty.
- * @return 1 if empty; 0 otherwise.
+ * Adds an array of bytes to a ring buffer from the producer side of a
+ * single-producer/single-consumer pair (e.g. an ISR feeding a task).
+ * Only \c head_index is written; bytes that do not fit are not queued.
+ * @param buffer The buffer in which the data should be placed.
+ * @param data A pointer to the array of bytes to place in the queue.
+ * @param size The size of the array.
+ * @return The number of bytes queued.
  */
-static inline uint8_t ring_buffer_is_empty(ring_buffer_t *buffer)
+ring_buffer_size_t ring_buffer_spsc_queue_arr(ring_buffer_t *buffer, const char *data, ring_buffer_size_t size);
+
+/**
+ * Adds an array of bytes to a ring buffer from the producer side of a
+ * single-producer/single-consumer pair, overwriting the oldest bytes when
+ * it does not fit. The tail is pushed forward with a compare-and-swap so a
+ * concurrent consumer never moves it back; bytes the consumer was reading
+ * at that moment may already be replaced by the new data.
+ * @param buffer The buffer in which the data should be placed.
+ * @param data A pointer to the array of bytes to place in the queue.
+ * @param size The size of the array.
+ * @return The number of bytes lost: old bytes overwritten plus leading
+ *         bytes of <em>data</em> skipped because <em>size</em> exceeds the capacity.
+ */
+ring_buffer_size_t ring_buffer_spsc_overwrite_arr(ring_buffer_t *buffer, const char *data, ring_buffer_size_t size);
+
+/**
+ * Returns the largest contiguous writable region of a ring buffer, so the
+ * producer can fill ring memory in place (recv(), UART FIFO reads).
+ * Call ring_buffer_commit() afterwards to publish what was written.
+ * A second call after a commit returns the wrapped-around part, if any.
+ * @param buffer The buffer to write into.
+ * @param span Set to the start of the writable region.
+ * @return The number of bytes that may be written at <em>span</em>; 0 if full.
+ */
+ring_buffer_size_t ring_buffer_reserve(ring_buffer_t *buffer, char **span);
+
+/**
+ * Publishes <em>len</em> bytes written into the region from ring_buffer_reserve().
+ * @param buffer The buffer that was written.
+ * @param len Number of bytes written; must not exceed the reserved length.
+ */
+void ring_buffer_commit(ring_buffer_t *buffer, ring_buffer_size_t len);
+
+/**
+ * Returns the largest contiguous readable region of a ring buffer, so the
+ * consumer can use ring memory in place (send(), UART FIFO writes).
+ * Call ring_buffer_consume() afterwards to release what was used.
+ * A second call after a consume returns the wrapped-around part, if any.
+ * @param buffer The buffer to read from.
+ * @param span Set to the start of the oldest readable bytes.
+ * @return The number of bytes readable at <em>span</em>; 0 if empty.
+ */
+ring_buffer_size_t ring_buffer_peek_span(ring_buffer_t *buffer, char **span);
+
+/**
+ * Releases the <em>len</em> oldest bytes after ring_buffer_peek_span().
+ * If the producer overwrote past these bytes meanwhile, the tail is left where
+ * the producer put it.
+ * @param buffer The buffer that was read.
+ * @param len Number of bytes used; must not exceed the length returned by the peek.
+ */
+void ring_buffer_consume(ring_buffer_t *buffer, ring_buffer_size_t len);
+
+/**
+ * Returns the readable region from the free-running index <em>index</em> up to
+ * <em>len</em> bytes as at most two segments (before and after the wrap point),
+ * so that it can be handed to a scatter-gather call without copying. Used by a
+ * consumer that keeps several read cursors (one per network client).
+ * Nothing is released; see ring_buffer_release_to().
+ * @param buffer The buffer to read from.
+ * @param index A cursor between the tail and the head.
+ * @param len The maximum number of bytes to return.
+ * @param span Set to the start of each segment.
+ * @param span_len Set to the length of each segment; <em>span_len[1]</em> is 0 if the region does not wrap.
+ * @return The total number of bytes in both segments.
+ */
+ring_buffer_size_t ring_buffer_peek_spans_at(ring_buffer_t *buffer, ring_buffer_size_t index, ring_buffer_size_t len,
+                                             char *span[2], ring_buffer_size_t span_len[2]);
+
+/**
+ * Releases everything before the free-running index <em>index</em>, i.e. moves
+ * the tail up to the slowest read cursor. An index the tail has already
+ * passed is ignored.
+ * @param buffer The buffer that was read.
+ * @param index The new tail.
+ */
+void ring_buffer_release_to(ring_buffer_t *buffer, ring_buffer_size_t index);
+
+/**
+ * Returns the number of items in a ring buffer.
+ * @param buffer The buffer for which the number of items should be returned.
+ * @return The number of items in the ring buffer.
+ */
+ring_buffer_size_t ring_buffer_num(ring_buffer_t *buffer);
+
+/**
+ * Returns the free-running head index (one past the newest byte).
+ * @param buffer The buffer for which the head should be returned.
+ * @return The head index.
+ */
+static inline ring_buffer_size_t ring_buffer_head(ring_buffer_t *buffer)
 {
-    return (buffer->head_index == buffer->tail_index);
+    return RING_BUFFER_LOAD_ACQUIRE(&buffer->head_index);
 }
 
 /**
- * Returns whether a ring buffer is full.
- * @param buffer The buffer for which it should be returned whether it is full.
- * @return 1 if full; 0 otherwise.
+ * Returns the free-running tail index (the oldest byte still held).
+ * @param buffer The buffer for which the tail should be returned.
+ * @return The tail index.
  */
-static inline uint8_t ring_buffer_is_full(ring_buffer_t *buffer)
+static inline ring_buffer_size_t ring_buffer_tail(ring_buffer_t *buffer)
+{
+    return RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index);
+}
+
+/**
+ * Returns whether a ring buffer is empty.
+ * @param buffer The buffer for which it should be returned whether it is empty.
+ * @return 1 if empty; 0 otherwise.
+ */
+static inline uint8_t ring_buffer_is_empty(ring_buffer_t *buffer)
 {
-    return ((buffer->head_index - buffer->tail_index) & RING_BUFFER_MASK(buffer)) == RING_BUFFER_MASK(buffer);
+    return (RING_BUFFER_LOAD_ACQUIRE(&buffer->head_index) == RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index));
 }
 
 /**
@@ -138,7 +278,28 @@ static inline uint8_t ring_buffer_is_full(ring_buffer_t *buffer)
  */
 static inline ring_buffer_size_t ring_buffer_num_items(ring_buffer_t *buffer)
 {
-    return ((buffer->head_index - buffer->tail_index) & RING_BUFFER_MASK(buffer));
+    ring_buffer_size_t tail = RING_BUFFER_LOAD_ACQUIRE(&buffer->tail_index);
+    return (RING_BUFFER_LOAD_ACQUIRE(&buffer->head_index) - tail);
+}
+
+/**
+ * Returns the number of free bytes in a ring buffer.
+ * @param buffer The buffer for which the free space should be returned.
+ * @return The number of bytes that can be queued without overwriting.
+ */
+static inline ring_buffer_size_t ring_buffer_num_free(ring_buffer_t *buffer)
+{
+    return (RING_BUFFER_CAPACITY(buffer) - ring_buffer_num_items(buffer));
+}
+
+/**
+ * Returns whether a ring buffer is full.
+ * @param buffer The buffer for which it should be returned whether it is full.
+ * @return 1 if full; 0 otherwise.
+ */
+static inline uint8_t ring_buffer_is_full(ring_buffer_t *buffer)
+{
+    return (ring_buffer_num_items(buffer) == RING_BUFFER_CAPACITY(buffer));
 }
 
 #ifdef __cplusplus
@@ -95,6 +95,40 @@ void user_task_print_message(void *arg) {
 	LOG_INFO("Timer tick! Arg: %s\n", (char *) arg);
 }
 
+/* ---------------- 时间戳 (执行时间与延迟测量) ---------------- */
+
+static UINT32 s_timestamp_period = 0;
+static UINT32 s_timestamp_freq = 0;
+
+/*
+ * 启用系统时间戳计数器，应在任何测量之前调用一次
+ */
+void hal_timestamp_init(void) {
+	sysTimestampEnable();
+	s_timestamp_period = sysTimestampPeriod();
+	s_timestamp_freq = sysTimestampFreq();
+}
+
+/*
+ * 计算两个 sysTimestamp() 值之间的计数，计数器每 s_timestamp_period 回零一次
+ */
+UINT32 hal_timestamp_elapsed(UINT32 start, UINT32 end) {
+	if (end >= start) {
+		return end - start;
+	}
+	return end + s_timestamp_period - start;
+}
+
+/*
+ * 将时间戳计数换算为微秒
+ */
+UINT32 hal_timestamp_to_us(UINT32 ticks) {
+	if (s_timestamp_freq == 0) {
+		return 0;
+	}
+	return (UINT32) ((UINT64) ticks * 1000000 / s_timestamp_freq);
+}
+
 /* ---------------- 启动/停止/监视 函数 ---------------- */
 
 /*
@@ -11,6 +11,19 @@ extern "C" {
 /* û̬ע */
 typedef void (*APP_TASK_CALLBACK)(void *arg);
 
+/* ϵͳʱ (BSPṩ) */
+IMPORT UINT32 sysTimestamp(void);
+IMPORT UINT32 sysTimestampFreq(void);
+IMPORT UINT32 sysTimestampPeriod(void);
+IMPORT STATUS sysTimestampEnable(void);
+
+void hal_timestamp_init(void);
+UINT32 hal_timestamp_elapsed(UINT32 start, UINT32 end);
+UINT32 hal_timestamp_to_us(UINT32 ticks);
+
+void app_start_hz(int unit, int hz);
+STATUS app_register_task(APP_TASK_CALLBACK func, void *arg);
+
 #ifdef __cplusplus
 }
 #endif
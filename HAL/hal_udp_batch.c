@@ -0,0 +1,59 @@
+/*
+ * =====================================================================================
+ *
+ * Filename:  hal_udp_batch.c
+ *
+ * Description:  实现 UDP 数据报的批量发送。
+ * 同一批数据报 (多个帧 x 多个目的地址) 尽量用一次系统调用提交，
+ * 平台不支持时退回逐个 sendmsg()。
+ *
+ * =====================================================================================
+ */
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE                 // sendmmsg()
+#endif
+#endif
+
+#include "hal_udp_batch.h"
+
+#ifdef __linux__
+/* ------------------ 主机实现: sendmmsg() ------------------ */
+#include <sys/socket.h>
+
+// udp_batch_msg_t 必须与 struct mmsghdr 布局一致
+typedef char udp_batch_layout_check[(sizeof(udp_batch_msg_t) == sizeof(struct mmsghdr)) ? 1 : -1];
+
+int udp_send_batch(int fd, udp_batch_msg_t *msgs, int count)
+{
+    int sent = 0;
+
+    while (sent < count) {
+        int n = sendmmsg(fd, (struct mmsghdr *)(msgs + sent), (unsigned int)(count - sent), 0);
+        if (n <= 0) {
+            return (sent > 0) ? sent : ERROR;
+        }
+        sent += n;
+    }
+    return sent;
+}
+
+#else
+/* ------------------ VxWorks 实现: sendmsg() 循环 ------------------ */
+
+int udp_send_batch(int fd, udp_batch_msg_t *msgs, int count)
+{
+    int k;
+
+    for (k = 0; k < count; k++) {
+        int n = sendmsg(fd, &msgs[k].msg_hdr, 0);
+        if (n < 0) {
+            return (k > 0) ? k : ERROR;
+        }
+        msgs[k].msg_len = (unsigned int)n;
+    }
+    return count;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,35 @@
+#ifndef HAL_UDP_BATCH_H
+#define HAL_UDP_BATCH_H
+
+#include <vxWorks.h>
+#include <sockLib.h>
+
+#ifndef UDP_BATCH_MAX
+#define UDP_BATCH_MAX        (32)                        // 一次提交的数据报数上限
+#endif
+
+/**
+ * @brief 批量发送中的一个数据报
+ * @details 布局与 Linux 的 struct mmsghdr 相同，主机上可直接交给 sendmmsg()。
+ */
+typedef struct {
+    struct msghdr msg_hdr;                               // 目的地址与数据段
+    unsigned int  msg_len;                               // 输出: 协议栈接受的字节数
+} udp_batch_msg_t;
+
+/* ------------------ Public API Functions ------------------ */
+
+/**
+ * @brief 在一个 UDP socket 上依次发送多个数据报
+ * @details Linux 主机上以 sendmmsg() 实现，一次系统调用提交整批；
+ * VxWorks 上没有 sendmmsg()，以紧凑的 sendmsg() 循环实现。
+ * 遇到第一个失败的数据报即停止，其余数据报由调用者决定重试或跳过。
+ *
+ * @param fd 非阻塞的 UDP socket。
+ * @param msgs 数据报数组。
+ * @param count 数据报数。
+ * @return int 从第一个开始连续发出的数据报数；第一个就失败时返回 ERROR，errno 指明原因。
+ */
+int udp_send_batch(int fd, udp_batch_msg_t *msgs, int count);
+
+#endif /* HAL_UDP_BATCH_H */
@@ -0,0 +1,138 @@
+/*
+ * 分隔符打包的查找吞吐量: packer_find_delim() 与逐字节循环比较，单字节 (delimiter1) 和
+ * 双字节 (delimiter1 + delimiter2) 分隔符各测一次，结果以 GB/s 给出。
+ *
+ * 直接包含 app_net_packing.c，pack_scan_byte() 按 PACK_SCAN_SWAR 选择按机器字比较或逐字节的实现
+ * (Makefile 中 bench_pack_scan_byte 以 -DPACK_SCAN_SWAR=0 编译)。计时前先用随机数据和
+ * 随机的起点/长度/回绕位置核对两者的结果一致，不一致时返回非0。
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "../APP/app_net_packing.c"
+#include "test_common.h"
+
+#define RING_SIZE   (64 * 1024)
+#define SCAN_LEN    (RING_SIZE - 64)
+#define BYTES       (1024ul * 1024 * 1024)
+
+SystemConfiguration g_system_config;
+UINT32 hal_timestamp_to_us(UINT32 ticks) { return ticks; }
+void net_scheduler_wake(void) {}
+
+static char s_mem[RING_SIZE] __attribute__((aligned(64)));
+static volatile ring_buffer_size_t s_sink;
+
+/* 逐字节查找分隔符，返回值和 delim1_seen 的语义与 packer_find_delim() 相同 */
+static ring_buffer_size_t byte_find_delim(ChannelPacker *pk, ring_buffer_t *rb, ring_buffer_size_t len,
+                                          const DataPackingSettings *cfg, ring_buffer_size_t *delim_start)
+{
+    ring_buffer_size_t k;
+
+    for (k = 0; k < len; k++) {
+        ring_buffer_size_t pos = pk->scan_pos + k;
+        unsigned char c = (unsigned char)rb->buffer[pos & RING_BUFFER_MASK(rb)];
+
+        if (cfg->delimiter2 == 0) {
+            if (c == cfg->delimiter1) {
+                *delim_start = pos;
+                return k + 1;
+            }
+        } else {
+            if (pk->delim1_seen && c == cfg->delimiter2) {
+                *delim_start = pos - 1;
+                return k + 1;
+            }
+            pk->delim1_seen = (c == cfg->delimiter1);
+        }
+    }
+    return 0;
+}
+
+/* 随机数据上两种查找的结果比较，返回不一致的次数 */
+static int check_equivalence(ring_buffer_t *rb)
+{
+    unsigned int seed = 7;
+    int it, k, bad = 0;
+
+    for (it = 0; it < 200000; it++) {
+        DataPackingSettings cfg;
+        ChannelPacker a, b;
+        ring_buffer_size_t len, ra, rr, da = 0, db = 0;
+        ring_buffer_size_t start = (ring_buffer_size_t)it * 37;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.delimiter1 = 1 + rand_r(&seed) % 4;
+        cfg.delimiter2 = (rand_r(&seed) % 2) ? 1 + rand_r(&seed) % 4 : 0;
+        // 每个位置只用几个取值，分隔符频繁出现；每3次把起点放在物理末端附近以跨越回绕点
+        if (rand_r(&seed) % 3 == 0) {
+            start = RING_SIZE - 1 - rand_r(&seed) % 40;
+        }
+        for (k = 0; k < 64; k++) {
+            s_mem[(start + k) & (RING_SIZE - 1)] = (char)(rand_r(&seed) % (4 + rand_r(&seed) % 60));
+        }
+        memset(&a, 0, sizeof(a));
+        a.scan_pos = start;
+        a.delim1_seen = cfg.delimiter2 ? rand_r(&seed) % 2 : 0;
+        b = a;
+        len = rand_r(&seed) % 64;
+        rb->tail_index = start;
+        rb->head_index = start + len;
+
+        ra = packer_find_delim(&a, rb, len, &cfg, &da);
+        rr = byte_find_delim(&b, rb, len, &cfg, &db);
+        if (ra != rr || (ra != 0 && da != db) || (ra == 0 && a.delim1_seen != b.delim1_seen)) {
+            bad++;
+        }
+    }
+    return bad;
+}
+
+/* 在没有分隔符的数据上查找 SCAN_LEN 字节，返回 GB/s */
+static double run(ring_buffer_t *rb, const DataPackingSettings *cfg, int swar)
+{
+    unsigned long scanned = 0;
+    double t0 = test_now_sec();
+    int r = 0;
+
+    while (scanned < BYTES) {
+        ChannelPacker pk;
+        ring_buffer_size_t d;
+
+        memset(&pk, 0, sizeof(pk));
+        pk.scan_pos = (ring_buffer_size_t)r++ * 13; // 起点不对齐，且每次跨越回绕点
+        rb->tail_index = pk.scan_pos;
+        rb->head_index = pk.scan_pos + SCAN_LEN;
+        s_sink = swar ? packer_find_delim(&pk, rb, SCAN_LEN, cfg, &d)
+                      : byte_find_delim(&pk, rb, SCAN_LEN, cfg, &d);
+        scanned += SCAN_LEN;
+    }
+    return scanned / (test_now_sec() - t0) / 1e9;
+}
+
+int main(void)
+{
+    ring_buffer_t rb;
+    int mode, k, bad;
+
+    ring_buffer_init(&rb, s_mem, sizeof(s_mem));
+    bad = check_equivalence(&rb);
+    printf("pack_scan_byte: %s, equivalence mismatches: %d\n",
+           PACK_SCAN_SWAR ? "SWAR" : "byte loop", bad);
+
+    for (k = 0; k < RING_SIZE; k++) {
+        s_mem[k] = (char)('a' + k % 26);
+    }
+    printf("%-14s %18s %14s %8s\n", "delimiter", "find_delim GB/s", "byte GB/s", "speedup");
+    for (mode = 0; mode < 2; mode++) {
+        DataPackingSettings cfg;
+        double fast, byte;
+
+        memset(&cfg, 0, sizeof(cfg));
+        cfg.delimiter1 = '\n';
+        cfg.delimiter2 = mode ? '\r' : 0;
+        fast = run(&rb, &cfg, 1);
+        byte = run(&rb, &cfg, 0);
+        printf("%-14s %18.2f %14.2f %7.1fx\n", mode ? "delimiter1+2" : "delimiter1", fast, byte, fast / byte);
+    }
+    return bad ? 1 : 0;
+}
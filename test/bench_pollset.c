@@ -0,0 +1,99 @@
+/*
+ * 网络调度任务每个周期等待就绪 fd 的开销 (16通道 x 8客户端 = 128 个 socketpair，其中1个可读)。
+ *
+ * 原实现: 每个周期为全部客户端重建 fd_set 并 select() 一次，再为每个通道各 select() 一次可写。
+ * 现实现: poll_set_wait()，集合只在连接建立/关闭时更新；主机上为 epoll，
+ * 另以 -U__linux__ 编译的 select() 实现 (VxWorks 上使用的版本) 单独计时。
+ */
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal_pollset.h"
+#include "test_common.h"
+
+#ifndef POLL_SET_BACKEND
+#define POLL_SET_BACKEND "epoll"
+#endif
+
+#define CHANNELS    (16)
+#define CLIENTS     (8)
+#define TICKS       (20000)
+
+static int s_fd[CHANNELS][CLIENTS];
+static int s_peer[CHANNELS][CLIENTS];
+
+/* 原 run_net_recv() + run_net_send() 的等待部分 */
+static void rebuild_and_select(void)
+{
+    fd_set readfds, writefds;
+    struct timeval tv;
+    int i, j, max_fd = 0;
+
+    FD_ZERO(&readfds);
+    for (i = 0; i < CHANNELS; i++) {
+        for (j = 0; j < CLIENTS; j++) {
+            FD_SET(s_fd[i][j], &readfds);
+            if (s_fd[i][j] > max_fd) {
+                max_fd = s_fd[i][j];
+            }
+        }
+    }
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    select(max_fd + 1, &readfds, NULL, NULL, &tv);
+
+    for (i = 0; i < CHANNELS; i++) {
+        FD_ZERO(&writefds);
+        max_fd = 0;
+        for (j = 0; j < CLIENTS; j++) {
+            FD_SET(s_fd[i][j], &writefds);
+            if (s_fd[i][j] > max_fd) {
+                max_fd = s_fd[i][j];
+            }
+        }
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+        select(max_fd + 1, NULL, &writefds, NULL, &tv);
+    }
+}
+
+int main(void)
+{
+    poll_event_t ev[POLL_SET_MAX_FDS];
+    double t0, t_select, t_pollset;
+    int i, j, k, n = 0;
+
+    for (i = 0; i < CHANNELS; i++) {
+        for (j = 0; j < CLIENTS; j++) {
+            int sv[2];
+
+            socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+            s_fd[i][j] = sv[0];
+            s_peer[i][j] = sv[1];
+        }
+    }
+    write(s_peer[3][2], "x", 1);
+
+    t0 = test_now_sec();
+    for (k = 0; k < TICKS; k++) {
+        rebuild_and_select();
+    }
+    t_select = test_now_sec() - t0;
+
+    poll_set_init();
+    for (i = 0; i < CHANNELS; i++) {
+        for (j = 0; j < CLIENTS; j++) {
+            poll_set_add(s_fd[i][j], POLL_SET_IN, (i << 8) | j);
+        }
+    }
+    t0 = test_now_sec();
+    for (k = 0; k < TICKS; k++) {
+        n = poll_set_wait(ev, POLL_SET_MAX_FDS, 0);
+    }
+    t_pollset = test_now_sec() - t0;
+
+    printf("rebuild fd_set + 17 select(): %8.2f us/tick\n", t_select / TICKS * 1e6);
+    printf("poll_set_wait (%s): %12.2f us/tick  (%d ready, tag %#x)\n", POLL_SET_BACKEND,
+           t_pollset / TICKS * 1e6, n, (n > 0) ? ev[0].tag : 0);
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * 串口收发周期访问通道状态的开销: 原布局与 ChannelRuntime 数组 + 活跃通道位图比较。
+ *
+ * 原布局: 每个通道的 ChannelState 内嵌两个 512KB 的环形缓冲区存储区，uart_state/num_clients、
+ * ring_buffer_t 和收发计数分散在相距约 1MB 的页上，每个周期扫描全部16个通道。
+ * 新布局: g_system_config.runtime[] 中16个64字节对齐的 ChannelRuntime，只按
+ * g_channel_active_mask 遍历活跃通道。
+ *
+ * 目标板上定时器周期之间网络协议栈等会冲掉 cache，每个周期前遍历一块大于L2的缓冲区模拟这一点
+ * (不计入时间)；同时给出 cache 中已有数据时的结果。
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "inc/app_com.h"
+#include "test_common.h"
+
+#define LEGACY_RING_SIZE    (512 * 1024)
+#define EVICT_BYTES         (4 * 1024 * 1024)     // 大于主机L2 (目标板L2为512KB)
+#define TICKS               (10000)
+
+/* 原 ChannelState 中收发周期访问的字段及其相对位置 */
+typedef struct {
+    UartPhysicalState uart_state;
+    int num_clients;
+    char config[2048];              // 串口/网络配置
+    ring_buffer_t buffer_net;
+    ring_buffer_t buffer_uart;
+    char net_buffer_mem[LEGACY_RING_SIZE];
+    char uart_buffer_mem[LEGACY_RING_SIZE];
+    unsigned int tx_count;
+    unsigned int rx_count;
+} LegacyChannel;
+
+SystemConfiguration g_system_config;
+volatile uint32_t g_channel_active_mask;
+
+static LegacyChannel *s_legacy;
+static char s_rt_mem[NUM_PORTS][2][4096];
+static char *s_evict;
+static volatile unsigned long s_sink;
+
+static void evict_cache(void)
+{
+    unsigned long sum = 0;
+    size_t k;
+
+    for (k = 0; k < EVICT_BYTES; k += 64) {
+        sum += s_evict[k]++;
+    }
+    s_sink = sum;
+}
+
+/* 原实现: 扫描全部通道，由 uart_state/num_clients 判断是否活跃 */
+static void legacy_tick(void)
+{
+    int i;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        LegacyChannel *ch = &s_legacy[i];
+
+        if (ch->uart_state != UART_STATE_OPENED || ch->num_clients == 0) {
+            continue;
+        }
+        if (ring_buffer_num_free(&ch->buffer_uart) > 0) {
+            ch->rx_count++;
+        }
+        if (!ring_buffer_is_empty(&ch->buffer_net)) {
+            ch->tx_count++;
+        }
+    }
+}
+
+/* 现实现: 只遍历活跃通道位图，访问紧凑的 ChannelRuntime */
+static void runtime_tick(void)
+{
+    uint32_t active = g_channel_active_mask;
+    int i;
+
+    while (active) {
+        ChannelRuntime *rt;
+
+        i = __builtin_ctz(active);
+        active &= active - 1;
+        rt = &g_system_config.runtime[i];
+        if (ring_buffer_num_free(&rt->buffer_uart) > 0) {
+            rt->rx_count++;
+        }
+        if (!ring_buffer_is_empty(&rt->buffer_net)) {
+            rt->tx_count++;
+        }
+    }
+}
+
+static void setup(int num_active)
+{
+    int i;
+
+    g_channel_active_mask = 0;
+    for (i = 0; i < NUM_PORTS; i++) {
+        // 活跃通道分散在各个端口上
+        int active = (i * num_active / NUM_PORTS) != ((i + 1) * num_active / NUM_PORTS);
+
+        s_legacy[i].uart_state = active ? UART_STATE_OPENED : UART_STATE_CLOSED;
+        s_legacy[i].num_clients = active;
+        ring_buffer_init(&s_legacy[i].buffer_net, s_legacy[i].net_buffer_mem, LEGACY_RING_SIZE);
+        ring_buffer_init(&s_legacy[i].buffer_uart, s_legacy[i].uart_buffer_mem, LEGACY_RING_SIZE);
+        ring_buffer_init(&g_system_config.runtime[i].buffer_net, s_rt_mem[i][0], sizeof(s_rt_mem[i][0]));
+        ring_buffer_init(&g_system_config.runtime[i].buffer_uart, s_rt_mem[i][1], sizeof(s_rt_mem[i][1]));
+        if (active) {
+            g_channel_active_mask |= 1u << i;
+        }
+    }
+}
+
+/* 返回每个周期的平均纳秒数 */
+static double run(void (*tick)(void), int cold)
+{
+    double total = 0;
+    int k;
+
+    for (k = 0; k < TICKS; k++) {
+        double t0;
+
+        if (cold) {
+            evict_cache();
+        }
+        t0 = test_now_sec();
+        tick();
+        total += test_now_sec() - t0;
+    }
+    return total / TICKS * 1e9;
+}
+
+int main(void)
+{
+    static const int actives[] = { 1, 4, 16 };
+    size_t k;
+    int cold;
+
+    s_legacy = calloc(NUM_PORTS, sizeof(LegacyChannel));
+    s_evict = calloc(1, EVICT_BYTES);
+    printf("LegacyChannel %zu bytes, ChannelRuntime %zu bytes\n", sizeof(LegacyChannel), sizeof(ChannelRuntime));
+    printf("%6s %7s %14s %14s %8s\n", "cache", "active", "legacy ns", "runtime ns", "speedup");
+    for (cold = 1; cold >= 0; cold--) {
+        for (k = 0; k < sizeof(actives) / sizeof(actives[0]); k++) {
+            double legacy, runtime;
+
+            setup(actives[k]);
+            legacy = run(legacy_tick, cold);
+            runtime = run(runtime_tick, cold);
+            printf("%6s %7d %14.0f %14.0f %7.1fx\n", cold ? "cold" : "warm", actives[k],
+                   legacy, runtime, legacy / runtime);
+        }
+    }
+    return 0;
+}
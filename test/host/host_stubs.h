@@ -0,0 +1,15 @@
+#ifndef HOST_STUBS_H
+#define HOST_STUBS_H
+
+/* host_stubs.c 中可由测试控制的 VxWorks 状态 */
+
+#include <vxWorks.h>
+
+extern UINT32 host_timestamp;           // sysTimestamp() 的返回值
+extern unsigned long host_tick;         // tickGet() 的返回值
+extern int host_int_locked;             // intLock() 嵌套深度
+
+/* 信号量的当前计数 (semGive 次数 - 成功的 semTake 次数) */
+int host_sem_count(SEM_ID sem);
+
+#endif /* HOST_STUBS_H */
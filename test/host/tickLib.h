@@ -0,0 +1 @@
+#include <vxWorks.h>
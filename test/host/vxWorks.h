@@ -0,0 +1,104 @@
+#ifndef HOST_VXWORKS_H
+#define HOST_VXWORKS_H
+
+/*
+ * 主机测试用的 VxWorks 替身头文件: 只提供被测源文件用到的类型、常量和函数声明，
+ * 函数由 host_stubs.c 或各测试文件实现。其余 VxWorks 头文件 (semLib.h 等) 都只包含本文件。
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <errno.h>
+
+typedef int STATUS;
+typedef int BOOL;
+typedef int TASK_ID;
+typedef void *SEM_ID;
+typedef void *MSG_Q_ID;
+typedef void *PIPE_ID;
+typedef int (*FUNCPTR)();
+typedef void (*VOIDFUNCPTR)();
+typedef unsigned char UINT8;
+typedef unsigned short UINT16;
+typedef unsigned int UINT32;
+typedef unsigned long long UINT64;
+typedef unsigned int UINT;
+typedef unsigned long ULONG;
+typedef int _Vx_usr_arg_t;
+
+#define OK                  0
+#define ERROR               (-1)
+#define TRUE                1
+#define FALSE               0
+#define LOCAL               static
+#define IMPORT              extern
+
+#define WAIT_FOREVER        (-1)
+#define NO_WAIT             0
+#define SEM_Q_FIFO          0
+#define SEM_Q_PRIORITY      1
+#define SEM_INVERSION_SAFE  8
+#define SEM_EMPTY           0
+#define SEM_FULL            1
+#define MSG_Q_FIFO          0
+#define MSG_Q_PRIORITY      1
+#define MSG_PRI_NORMAL      0
+#define VX_FP_TASK          8
+#define TASK_ID_ERROR       ERROR
+#define SEM_ID_NULL         NULL
+#define FIONBIO             0x10
+#define FIONREAD            0x11
+
+#define INUM_TO_IVEC(x)     ((VOIDFUNCPTR *)(long)(x))
+#define IVEC_TO_INUM(x)     ((int)(long)(x))
+
+/* semLib / msgQLib */
+SEM_ID semBCreate(int options, int initial);
+SEM_ID semMCreate(int options);
+SEM_ID semCCreate(int options, int initial);
+STATUS semTake(SEM_ID sem, int timeout);
+STATUS semGive(SEM_ID sem);
+STATUS semDelete(SEM_ID sem);
+MSG_Q_ID msgQCreate(int max_msgs, int max_len, int options);
+int msgQReceive(MSG_Q_ID q, char *buf, unsigned len, int timeout);
+STATUS msgQSend(MSG_Q_ID q, char *buf, unsigned len, int timeout, int pri);
+int msgQNumMsgs(MSG_Q_ID q);
+
+/* taskLib / intLib / tickLib / sysLib */
+TASK_ID taskSpawn(char *name, int pri, int options, size_t stack, FUNCPTR entry, ...);
+STATUS taskDelay(int ticks);
+TASK_ID taskIdSelf(void);
+STATUS taskDelete(TASK_ID tid);
+STATUS taskPrioritySet(TASK_ID tid, int pri);
+STATUS taskLock(void);
+STATUS taskUnlock(void);
+STATUS intConnect(VOIDFUNCPTR *vector, VOIDFUNCPTR routine, int param);
+int intLock(void);
+void intUnlock(int key);
+STATUS intEnable(int level);
+STATUS intDisable(int level);
+int intContext(void);
+unsigned long tickGet(void);
+UINT64 tick64Get(void);
+int sysClkRateGet(void);
+UINT32 sysTimestamp(void);
+UINT32 sysTimestampFreq(void);
+UINT32 sysTimestampPeriod(void);
+UINT32 sysTimestampLock(void);
+STATUS sysTimestampEnable(void);
+
+/* ioLib / logLib / pipeDrv / 其他 */
+STATUS ioctl(int fd, int function, ...);
+int logMsg(char *fmt, ...);
+int errnoGet(void);
+STATUS pipeDevCreate(char *name, int max_msgs, int max_len);
+void reboot(int type);
+
+#endif /* HOST_VXWORKS_H */
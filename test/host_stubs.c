@@ -0,0 +1,172 @@
+/*
+ * 主机测试用的 VxWorks 函数替身。
+ *
+ * 测试都是单线程驱动被测代码: 信号量只计数不阻塞 (semTake 在计数为0时返回 ERROR)，
+ * 消息队列是定长的环形数组，时间戳和 tick 由测试直接设置。
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "host_stubs.h"
+
+UINT32 host_timestamp;
+unsigned long host_tick;
+int host_int_locked;
+
+typedef struct {
+    int count;
+} host_sem_t;
+
+typedef struct {
+    int max_msgs;
+    int max_len;
+    int head;
+    int num;
+    char *buf;
+} host_msgq_t;
+
+SEM_ID semBCreate(int options, int initial)
+{
+    host_sem_t *s = calloc(1, sizeof(*s));
+
+    s->count = initial;
+    return s;
+}
+
+SEM_ID semMCreate(int options)
+{
+    return semBCreate(options, SEM_FULL);
+}
+
+SEM_ID semCCreate(int options, int initial)
+{
+    return semBCreate(options, initial);
+}
+
+STATUS semTake(SEM_ID sem, int timeout)
+{
+    host_sem_t *s = sem;
+
+    if (s == NULL || s->count == 0) {
+        return ERROR;
+    }
+    s->count--;
+    return OK;
+}
+
+STATUS semGive(SEM_ID sem)
+{
+    host_sem_t *s = sem;
+
+    if (s == NULL) {
+        return ERROR;
+    }
+    s->count++;
+    return OK;
+}
+
+STATUS semDelete(SEM_ID sem)
+{
+    free(sem);
+    return OK;
+}
+
+int host_sem_count(SEM_ID sem)
+{
+    return sem ? ((host_sem_t *)sem)->count : 0;
+}
+
+MSG_Q_ID msgQCreate(int max_msgs, int max_len, int options)
+{
+    host_msgq_t *q = calloc(1, sizeof(*q));
+
+    q->max_msgs = max_msgs;
+    q->max_len = max_len;
+    q->buf = calloc(max_msgs, max_len);
+    return q;
+}
+
+STATUS msgQSend(MSG_Q_ID id, char *buf, unsigned len, int timeout, int pri)
+{
+    host_msgq_t *q = id;
+
+    if (q == NULL || q->num == q->max_msgs || len > (unsigned)q->max_len) {
+        return ERROR;
+    }
+    memcpy(q->buf + ((q->head + q->num) % q->max_msgs) * q->max_len, buf, len);
+    q->num++;
+    return OK;
+}
+
+int msgQReceive(MSG_Q_ID id, char *buf, unsigned len, int timeout)
+{
+    host_msgq_t *q = id;
+
+    if (q == NULL || q->num == 0) {
+        return ERROR;
+    }
+    if (len > (unsigned)q->max_len) {
+        len = q->max_len;
+    }
+    memcpy(buf, q->buf + q->head * q->max_len, len);
+    q->head = (q->head + 1) % q->max_msgs;
+    q->num--;
+    return (int)len;
+}
+
+int msgQNumMsgs(MSG_Q_ID id)
+{
+    return id ? ((host_msgq_t *)id)->num : 0;
+}
+
+TASK_ID taskSpawn(char *name, int pri, int options, size_t stack, FUNCPTR entry, ...)
+{
+    static TASK_ID s_next_tid = 1;
+
+    return s_next_tid++;
+}
+
+STATUS taskDelay(int ticks)
+{
+    host_tick += ticks;
+    return OK;
+}
+
+STATUS intConnect(VOIDFUNCPTR *vector, VOIDFUNCPTR routine, int param)
+{
+    return OK;
+}
+
+int intLock(void)
+{
+    return host_int_locked++;
+}
+
+void intUnlock(int key)
+{
+    host_int_locked = key;
+}
+
+STATUS intEnable(int level)
+{
+    return OK;
+}
+
+unsigned long tickGet(void)
+{
+    return host_tick;
+}
+
+int sysClkRateGet(void)
+{
+    return 1000;
+}
+
+UINT32 sysTimestamp(void)
+{
+    return host_timestamp;
+}
+
+UINT32 sysTimestampFreq(void)
+{
+    return 100000000;
+}
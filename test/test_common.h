@@ -0,0 +1,39 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+/* 主机测试的最小断言与计时工具 */
+
+#include <stdio.h>
+#include <time.h>
+
+static int s_test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            s_test_failures++; \
+            if (s_test_failures <= 20) { \
+                printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            } \
+        } \
+    } while (0)
+
+/* 打印结果，作为 main() 的返回值 */
+static int test_report(const char *name)
+{
+    if (s_test_failures) {
+        printf("%s: FAILED (%d)\n", name, s_test_failures);
+        return 1;
+    }
+    printf("%s: OK\n", name);
+    return 0;
+}
+
+static double test_now_sec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#endif /* TEST_COMMON_H */
@@ -0,0 +1,456 @@
+/*
+ * 串口中断模式 (SERIAL_IO_MODE_IRQ) 的中断分发与 tSerialIO 处理。
+ *
+ * 直接包含 app_realtime.c，用一个16550寄存器模型替换 hal_axi16550 的接口:
+ * 每个端口有 IER、接收FIFO字节数、字符超时标志和发送FIFO空标志，IIR 按16550的优先级
+ * (RDA/超时 > THRE) 由这些状态算出，并记录每个端口的寄存器访问次数。检查:
+ * - uart_demux_isr() 只读已开启中断端口的 IIR，屏蔽产生中断的端口并记入 s_irq_pending；
+ * - serial_irq_service() 按 IIR 类型得到的 known 字节数不超过FIFO中的实际字节数，
+ *   并按环形缓冲区状态重写 IER，空闲端口不产生寄存器访问；
+ * - 预算耗尽的端口保持屏蔽、留到下一周期，失去客户端的端口关闭中断；
+ * - 定时器周期只在 IER 需要改写、有留到下一周期的端口或有未结束的字符间隔帧时唤醒 tSerialIO。
+ */
+#include <string.h>
+#include "../APP/app_realtime.c"
+#include "host_stubs.h"
+#include "test_common.h"
+
+#define RING_SIZE   (1024)
+
+typedef struct {
+    unsigned int ier;
+    uint32_t rx;                    // 接收FIFO中的字节数
+    int rx_timeout;                 // 字符超时已到 (rx 低于触发等级时产生超时中断)
+    int tx_empty;                   // 发送FIFO空
+    uint32_t trigger;               // 接收触发等级 (字节)
+    uint32_t sent;                  // 写入发送FIFO的字节数
+    unsigned int iir_reads;
+    unsigned int ier_writes;
+    unsigned int other_access;      // 收发数据及状态寄存器的访问
+} PortModel;
+
+static PortModel s_port[NUM_PORTS];
+static uint32_t s_known_violations;
+static int s_gap_pending;
+static char s_mem[NUM_PORTS][2][RING_SIZE];
+
+SystemConfiguration g_system_config;
+volatile uint32_t g_channel_active_mask;
+
+/* ------------------ 16550 寄存器模型 ------------------ */
+
+static const uint32_t s_trigger_bytes[4] = {
+    1, UART_HW_FIFO_SIZE / 4, UART_HW_FIFO_SIZE / 2, UART_HW_FIFO_SIZE * 7 / 8
+};
+
+uint32_t axi16550RxTriggerBytes(unsigned int level)
+{
+    return s_trigger_bytes[level & 3];
+}
+
+unsigned int axi16550IntId(unsigned int channel)
+{
+    PortModel *p = &s_port[channel];
+
+    p->iir_reads++;
+    if ((p->ier & IER_RDA) && p->rx >= p->trigger) {
+        return IIR_ID_RDA;
+    }
+    if ((p->ier & IER_RDA) && p->rx > 0 && p->rx_timeout) {
+        return IIR_ID_TIMEOUT;
+    }
+    if ((p->ier & IER_THRE) && p->tx_empty) {
+        return IIR_ID_THRE;
+    }
+    return IIR_NO_INT;
+}
+
+void axi16550IntEnable(unsigned int channel, unsigned int ier)
+{
+    s_port[channel].ier = ier;
+    s_port[channel].ier_writes++;
+}
+
+int axi16550RecvBurst(unsigned int channel, uint8_t *buffer, uint32_t known, uint32_t max, uint32_t *len)
+{
+    PortModel *p = &s_port[channel];
+    uint32_t n = (p->rx < max) ? p->rx : max;
+
+    // known 字节不查询LSR直接读取，超过FIFO中的实际字节数会读到无效数据
+    if (known > p->rx) {
+        s_known_violations++;
+    }
+    memset(buffer, (int)channel, n);
+    p->rx -= n;
+    if (p->rx == 0) {
+        p->rx_timeout = 0;
+    }
+    p->other_access++;
+    *len = n;
+    return 0;
+}
+
+int axi16550_TxReady(unsigned int channel)
+{
+    s_port[channel].other_access++;
+    return s_port[channel].tx_empty;
+}
+
+int axi16550SendNoWait(unsigned int channel, uint8_t *buffer, uint32_t len)
+{
+    s_port[channel].sent += len;
+    s_port[channel].tx_empty = 0;
+    s_port[channel].other_access++;
+    return 0;
+}
+
+uint32_t UART_RX_Ready_Mask(void) { return 0; }
+uint32_t UART_TX_Empty_Mask(void) { return 0; }
+void axi165502CInit(usart_info_t *uart_instance, int channel) {}
+void txled(int i, int action) {}
+void rxled(int i, int action) {}
+
+/* ------------------ app_realtime.c 依赖的其他模块 ------------------ */
+
+void log_printf(LogLevel level, const char *file, int line, const char *format, ...) {}
+UINT32 hal_timestamp_elapsed(UINT32 start, UINT32 end) { return end - start; }
+UINT32 hal_timestamp_to_us(UINT32 ticks) { return ticks; }
+void app_start_hz(int unit, int hz) {}
+STATUS app_register_task(APP_TASK_CALLBACK func, void *arg) { return OK; }
+void packer_gap_rx(int channel_index, ring_buffer_size_t start, UINT32 clock) {}
+void packer_gap_poll(UINT32 clock) {}
+BOOL packer_gap_pending(void) { return s_gap_pending; }
+void net_scheduler_notify_rx(int channel_index, ring_buffer_size_t fill_before) {}
+void net_scheduler_notify_tx(int channel_index) {}
+STATUS channel_buffers_attach(int channel_index) { return OK; }
+void dev_channel_activity_update(int channel_index) {}
+
+/* ------------------ 测试 ------------------ */
+
+static void reset(void)
+{
+    int i;
+
+    memset(s_port, 0, sizeof(s_port));
+    memset(&g_system_config, 0, sizeof(g_system_config));
+    for (i = 0; i < NUM_PORTS; i++) {
+        ring_buffer_init(&g_system_config.runtime[i].buffer_net, s_mem[i][0], RING_SIZE);
+        ring_buffer_init(&g_system_config.runtime[i].buffer_uart, s_mem[i][1], RING_SIZE);
+        g_system_config.channels[i].overflow_policy = OVERFLOW_POLICY_BLOCK;
+        s_port[i].trigger = s_trigger_bytes[0];
+        s_port[i].tx_empty = 1;
+    }
+    g_channel_active_mask = 0;
+    s_irq_ports = 0;
+    s_irq_pending = 0;
+    memset(s_port_ier, 0, sizeof(s_port_ier));
+    memset(s_port_iir, 0, sizeof(s_port_iir));
+    s_known_violations = 0;
+    s_gap_pending = 0;
+    semDelete(s_serial_io_sem);
+    s_serial_io_sem = semBCreate(SEM_Q_PRIORITY, SEM_EMPTY);
+}
+
+static void set_trigger(int i, unsigned int level)
+{
+    g_system_config.channels[i].rx_fifo_trigger = level;
+    s_port[i].trigger = s_trigger_bytes[level];
+}
+
+static void clear_access_counts(void)
+{
+    int i;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        s_port[i].iir_reads = 0;
+        s_port[i].ier_writes = 0;
+        s_port[i].other_access = 0;
+    }
+}
+
+/* 激活通道后第一个周期开启接收中断 */
+static void activate(uint32_t mask)
+{
+    int i;
+
+    g_channel_active_mask = mask;
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    for (i = 0; i < NUM_PORTS; i++) {
+        CHECK(s_port[i].ier == ((mask & (1u << i)) ? IER_RDA : 0));
+    }
+    CHECK(s_irq_ports == mask);
+    clear_access_counts();
+}
+
+/* 中断分发只访问已开启中断的端口，屏蔽产生中断的端口 */
+static void test_demux(void)
+{
+    int i;
+
+    reset();
+    activate((1u << 1) | (1u << 3) | (1u << 5));
+    s_port[3].rx = 1;                    // 触发等级1字节: RDA
+    s_port[7].rx = 100;                  // 未开启中断的端口
+
+    uart_demux_isr(NULL);
+    for (i = 0; i < NUM_PORTS; i++) {
+        CHECK(s_port[i].iir_reads == ((i == 1 || i == 3 || i == 5) ? 1u : 0u));
+    }
+    CHECK(s_irq_pending == (1u << 3));
+    CHECK(s_port_iir[3] == IIR_ID_RDA);
+    CHECK(s_port[3].ier == 0);           // 已屏蔽，数据读走前不再重入
+    CHECK(s_port[1].ier == IER_RDA && s_port[5].ier == IER_RDA);
+    CHECK(s_port[3].ier_writes == 1 && s_port[1].ier_writes == 0);
+    CHECK(host_sem_count(s_serial_io_sem) == 1);
+
+    // 屏蔽后再次进入中断不会重复上报
+    s_irq_pending = 0;
+    uart_demux_isr(NULL);
+    CHECK(s_irq_pending == 0);
+    CHECK(host_sem_count(s_serial_io_sem) == 1);
+
+    // 没有端口产生中断时不唤醒任务
+    reset();
+    activate(1u << 2);
+    uart_demux_isr(NULL);
+    CHECK(s_irq_pending == 0);
+    CHECK(host_sem_count(s_serial_io_sem) == 0);
+}
+
+/* RDA 与字符超时: known 不超过FIFO中的字节数，数据全部读入 buffer_uart，IER 恢复 */
+static void test_rx(void)
+{
+    ChannelRuntime *rt = &g_system_config.runtime[4];
+
+    reset();
+    set_trigger(4, 2);
+    activate(1u << 4);
+
+    s_port[4].rx = s_port[4].trigger + 10;
+    uart_demux_isr(NULL);
+    CHECK(s_port_iir[4] == IIR_ID_RDA);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(ring_buffer_num_items(&rt->buffer_uart) == s_port[4].trigger + 10);
+    CHECK(rt->rx_count == s_port[4].trigger + 10);
+    CHECK(s_port[4].rx == 0);
+    CHECK(s_port[4].ier == IER_RDA);
+    CHECK(s_irq_pending == 0);
+
+    // 低于触发等级的数据由字符超时上报，只能确定至少有1个字节
+    s_port[4].rx = 3;
+    uart_demux_isr(NULL);
+    CHECK(s_irq_pending == 0);           // 超时未到，不产生中断
+    s_port[4].rx_timeout = 1;
+    uart_demux_isr(NULL);
+    CHECK(s_port_iir[4] == IIR_ID_TIMEOUT);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(ring_buffer_num_items(&rt->buffer_uart) == s_port[4].trigger + 13);
+    CHECK(s_port[4].rx == 0);
+    CHECK(s_port[4].ier == IER_RDA);
+    CHECK(s_known_violations == 0);
+}
+
+/* 有待发数据时开启 THRE 中断，发送FIFO空时写入，数据发完后关闭 */
+static void test_tx(void)
+{
+    ChannelRuntime *rt = &g_system_config.runtime[9];
+    static char data[UART_HW_FIFO_SIZE + 100];
+
+    reset();
+    activate(1u << 9);
+    ring_buffer_queue_arr(&rt->buffer_net, data, sizeof(data));
+
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[9].ier == (IER_RDA | IER_THRE));
+    CHECK(s_port[9].sent == 0);          // 发送由 THRE 中断启动
+
+    uart_demux_isr(NULL);
+    CHECK(s_port_iir[9] == IIR_ID_THRE);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[9].sent == UART_HW_FIFO_SIZE);
+    CHECK(s_port[9].ier == (IER_RDA | IER_THRE));
+
+    // FIFO未空时不产生中断
+    uart_demux_isr(NULL);
+    CHECK(s_irq_pending == 0);
+
+    s_port[9].tx_empty = 1;
+    uart_demux_isr(NULL);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[9].sent == sizeof(data));
+    CHECK(ring_buffer_is_empty(&rt->buffer_net));
+    CHECK(s_port[9].ier == IER_RDA);
+    CHECK(rt->tx_count == sizeof(data));
+}
+
+/* 预算耗尽的端口保持屏蔽并留在 s_irq_pending，下一周期继续 */
+static void test_budget(void)
+{
+    reset();
+    activate((1u << 0) | (1u << 6));
+    s_port[0].rx = 50;
+    s_port[6].rx = 50;
+    uart_demux_isr(NULL);
+    CHECK(s_irq_pending == ((1u << 0) | (1u << 6)));
+
+    serial_irq_service(40);
+    CHECK(s_port[0].rx == 10);
+    CHECK(s_port[6].rx == 50);
+    CHECK(s_port[6].ier == 0);
+    CHECK(s_irq_pending == (1u << 6));
+    CHECK(s_port[0].ier == IER_RDA);
+
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[6].rx == 0);
+    CHECK(s_port[6].ier == IER_RDA);
+    CHECK(s_irq_pending == 0);
+
+    // 端口0剩余的数据在重新开启中断后立即上报
+    uart_demux_isr(NULL);
+    CHECK(s_irq_pending == (1u << 0));
+}
+
+/* 空闲端口没有寄存器访问；失去客户端的端口关闭中断；BLOCK 策略下缓冲区满时关闭接收中断 */
+static void test_idle_and_block(void)
+{
+    ChannelRuntime *rt = &g_system_config.runtime[2];
+    static char data[RING_SIZE];
+    int i;
+
+    reset();
+    activate((1u << 2) | (1u << 12));
+    for (i = 0; i < 100; i++) {
+        serial_irq_service(SERIAL_IO_NO_BUDGET);
+    }
+    for (i = 0; i < NUM_PORTS; i++) {
+        CHECK(s_port[i].iir_reads == 0 && s_port[i].ier_writes == 0 && s_port[i].other_access == 0);
+    }
+
+    g_channel_active_mask = 1u << 2;
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[12].ier == 0 && s_port[12].ier_writes == 1);
+    CHECK(s_irq_ports == (1u << 2));
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[12].ier_writes == 1);
+
+    ring_buffer_queue_arr(&rt->buffer_uart, data, RING_SIZE - 8);
+    s_port[2].rx = 20;
+    uart_demux_isr(NULL);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(ring_buffer_is_full(&rt->buffer_uart));
+    CHECK(s_port[2].rx == 12);           // 其余数据留在硬件FIFO中
+    CHECK(rt->rx_drop_count == 0);
+    CHECK(s_port[2].ier == 0);
+
+    // 有空间后重新开启接收中断
+    ring_buffer_consume(&rt->buffer_uart, 100);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[2].ier == IER_RDA);
+    uart_demux_isr(NULL);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[2].rx == 0);
+    CHECK(s_known_violations == 0);
+
+    serial_irq_disable_all();
+    CHECK(s_port[2].ier == 0);
+    CHECK(s_irq_ports == 0);
+}
+
+/* 定时器周期唤醒 tSerialIO 的次数 */
+static int timer_wakeups(int ticks)
+{
+    int before = host_sem_count(s_serial_io_sem);
+    int k;
+
+    for (k = 0; k < ticks; k++) {
+        high_precision_timer_isr(NULL);
+    }
+    return host_sem_count(s_serial_io_sem) - before;
+}
+
+/* 中断模式下空闲端口不引起定时唤醒，需要改写 IER、留有待处理端口或字符间隔帧未结束时才唤醒 */
+static void test_timer_tick(void)
+{
+    ChannelRuntime *rt = &g_system_config.runtime[5];
+    static char data[RING_SIZE];
+    int i;
+
+    reset();
+    s_serial_io_mode = SERIAL_IO_MODE_IRQ;
+    CHECK(timer_wakeups(100) == 0);
+
+    // 通道刚激活: 需要开启接收中断
+    g_channel_active_mask = (1u << 5) | (1u << 11);
+    CHECK(timer_wakeups(1) == 1);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    clear_access_counts();
+    CHECK(timer_wakeups(100) == 0);
+    for (i = 0; i < NUM_PORTS; i++) {
+        CHECK(s_port[i].iir_reads == 0 && s_port[i].ier_writes == 0 && s_port[i].other_access == 0);
+    }
+
+    // 网络侧写入 buffer_net: 需要开启 THRE 中断
+    ring_buffer_queue_arr(&rt->buffer_net, data, 10);
+    CHECK(timer_wakeups(1) == 1);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[5].ier == (IER_RDA | IER_THRE));
+    CHECK(timer_wakeups(1) == 0);
+    uart_demux_isr(NULL);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(ring_buffer_is_empty(&rt->buffer_net));
+    CHECK(timer_wakeups(1) == 0);
+
+    // BLOCK 策略下 buffer_uart 满时关闭接收中断，有空间后需要重新开启
+    ring_buffer_queue_arr(&rt->buffer_uart, data, RING_SIZE);
+    CHECK(timer_wakeups(1) == 1);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[5].ier == 0);
+    CHECK(timer_wakeups(1) == 0);
+    ring_buffer_consume(&rt->buffer_uart, 1);
+    CHECK(timer_wakeups(1) == 1);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(timer_wakeups(1) == 0);
+
+    // 预算耗尽留到下一周期的端口
+    ring_buffer_consume(&rt->buffer_uart, RING_SIZE - 1);
+    s_port[5].rx = 50;
+    s_port[11].rx = 50;
+    uart_demux_isr(NULL);
+    semTake(s_serial_io_sem, NO_WAIT);
+    serial_irq_service(40);
+    CHECK(s_irq_pending == (1u << 11));
+    CHECK(timer_wakeups(1) == 1);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_irq_pending == 0 && s_port[11].rx == 0);
+    uart_demux_isr(NULL);                // 端口5剩余的数据由串口中断上报
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[5].rx == 0);
+    CHECK(timer_wakeups(1) == 0);
+
+    // 未结束的字符间隔帧需要按周期判断线路空闲
+    s_gap_pending = 1;
+    CHECK(timer_wakeups(3) == 3);
+    s_gap_pending = 0;
+
+    // 通道失去客户端: 需要关闭中断
+    g_channel_active_mask = 1u << 5;
+    CHECK(timer_wakeups(1) == 1);
+    serial_irq_service(SERIAL_IO_NO_BUDGET);
+    CHECK(s_port[11].ier == 0);
+    CHECK(timer_wakeups(100) == 0);
+
+    // 任务模式下每个周期都唤醒
+    s_serial_io_mode = SERIAL_IO_MODE_TASK;
+    CHECK(timer_wakeups(5) == 5);
+}
+
+int main(void)
+{
+    test_demux();
+    test_rx();
+    test_tx();
+    test_budget();
+    test_idle_and_block();
+    test_timer_tick();
+    return test_report("test_irq_demux");
+}
@@ -0,0 +1,174 @@
+/*
+ * 网络调度任务接管数据连接后串口的打开与关闭。
+ *
+ * 直接包含 app_net_scheduler.c，与 app_dev.c (活跃通道位图)、app_net_packing.c 和 HAL 的
+ * 环形缓冲区/缓冲池/就绪集合一起编译，串口初始化接口替换为记录调用的替身。检查:
+ * - TCP Client 和 UDP 模式第一个连接接管后按通道保存的串口参数打开串口，通道进入 g_channel_active_mask，
+ *   之后的连接不再重复初始化串口；
+ * - 最后一个连接断开后串口关闭，通道离开活跃位图，TCP Client 目标收到断开通知；
+ * - 波特率无效时不打开串口，通道不进入活跃位图。
+ */
+#include <string.h>
+#include "../APP/app_net_scheduler.c"
+#include "host_stubs.h"
+#include "test_common.h"
+
+typedef struct {
+    int calls;
+    usart_info_t info;
+    unsigned int trigger;
+} UartInitModel;
+
+static UartInitModel s_uart[NUM_PORTS];
+static int s_closed_dest[NUM_PORTS];        // 最近一次断开通知的目标下标
+static int s_peer[NUM_PORTS][MAX_CLIENTS_PER_CHANNEL];
+
+SEM_ID g_config_mutex;
+
+/* ------------------ 串口与其他模块的替身 ------------------ */
+
+void axi165502CInit(usart_info_t *uart_instance, int channel)
+{
+    s_uart[channel].calls++;
+    s_uart[channel].info = *uart_instance;
+}
+
+void axi16550RxTriggerSet(unsigned int channel, unsigned int level)
+{
+    s_uart[channel].trigger = level;
+}
+
+void log_printf(LogLevel level, const char *file, int line, const char *format, ...) {}
+UINT32 hal_timestamp_elapsed(UINT32 start, UINT32 end) { return end - start; }
+UINT32 hal_timestamp_to_us(UINT32 ticks) { return ticks; }
+void serial_io_quiesce(void) {}
+STATUS pipeDevCreate(char *name, int max_msgs, int max_len) { return ERROR; }
+int net_cfg_set_network_settings(const char *interface_name, const char *ip_address, const char *netmask,
+                                 const char *gateway) { return 0; }
+
+STATUS ConnectionManager_NotifyDestinationClosed(int channel_index, int dest_index, int client_fd)
+{
+    s_closed_dest[channel_index] = dest_index;
+    return OK;
+}
+
+/* ------------------ 测试 ------------------ */
+
+static void setup_channel(int i, OperationMode mode, int baudrate)
+{
+    ChannelState *ch = &g_system_config.channels[i];
+
+    memset(ch, 0, sizeof(*ch));
+    ch->op_mode = mode;
+    ch->baudrate = baudrate;
+    ch->data_bits = 7;
+    ch->stop_bits = 2;
+    ch->parity = 2;
+    ch->rx_fifo_trigger = 3;
+    ch->ring_size = BUF_POOL_MIN_BLOCK;
+    ch->uart_state = UART_STATE_CLOSED;
+    s_closed_dest[i] = -1;
+}
+
+/* 经邮箱交给网络调度任务并接管 */
+static void hand_off(int i, ConnectionType type, int dest_index, int slot)
+{
+    NewConnectionMsg msg;
+    int sv[2];
+
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    s_peer[i][slot] = sv[1];
+    msg.type = type;
+    msg.channel_index = i;
+    msg.client_fd = sv[0];
+    msg.dest_index = dest_index;
+    CHECK(net_scheduler_handoff(&msg) == OK);
+    check_for_new_connections();
+}
+
+static void test_tcp_client(void)
+{
+    ChannelState *ch = &g_system_config.channels[3];
+
+    setup_channel(3, OP_MODE_TCP_CLIENT, 115200);
+    hand_off(3, CONN_TYPE_TCPCLIENT, 0, 0);
+    CHECK(ch->data_net_info.num_clients == 1);
+    CHECK(ch->uart_state == UART_STATE_OPENED);
+    CHECK(g_channel_active_mask == (1u << 3));
+    CHECK(g_system_config.runtime[3].buffer_uart.buffer != NULL);
+    CHECK(s_uart[3].calls == 1);
+    CHECK(s_uart[3].info.baud_rate == 115200 && s_uart[3].info.data_bit == 7);
+    CHECK(s_uart[3].info.stop_bit == 2 && s_uart[3].info.parity == 2);
+    CHECK(s_uart[3].trigger == 3);
+
+    // 其他目标的连接共用已打开的串口
+    hand_off(3, CONN_TYPE_TCPCLIENT, 2, 1);
+    CHECK(ch->data_net_info.num_clients == 2);
+    CHECK(s_uart[3].calls == 1);
+    CHECK(g_channel_active_mask == (1u << 3));
+
+    cleanup_data_connection(3, 1);
+    CHECK(s_closed_dest[3] == 2);
+    CHECK(ch->uart_state == UART_STATE_OPENED);
+    CHECK(g_channel_active_mask == (1u << 3));
+
+    cleanup_data_connection(3, 0);
+    CHECK(s_closed_dest[3] == 0);
+    CHECK(ch->data_net_info.num_clients == 0);
+    CHECK(ch->uart_state == UART_STATE_CLOSED);
+    CHECK(g_channel_active_mask == 0 && g_channel_client_mask == 0);
+    CHECK(g_system_config.runtime[3].buffer_uart.buffer == NULL);
+
+    // 重连后再次打开
+    hand_off(3, CONN_TYPE_TCPCLIENT, 1, 0);
+    CHECK(s_uart[3].calls == 2);
+    CHECK(g_channel_active_mask == (1u << 3));
+    cleanup_data_connection(3, 0);
+    CHECK(g_channel_active_mask == 0);
+}
+
+/* UDP 模式的 socket 占一个槽位，接管后打开串口，串口侧读入的帧才能发给各目的地址 */
+static void test_udp(void)
+{
+    ChannelState *ch = &g_system_config.channels[9];
+
+    setup_channel(9, OP_MODE_UDP, 921600);
+    hand_off(9, CONN_TYPE_UDP, -1, 0);
+    CHECK(ch->data_net_info.num_clients == 1);
+    CHECK(s_udp_slots[9] == 1u);
+    CHECK(ch->uart_state == UART_STATE_OPENED);
+    CHECK(g_channel_active_mask == (1u << 9));
+    CHECK(s_uart[9].calls == 1 && s_uart[9].info.baud_rate == 921600);
+
+    cleanup_data_connection(9, 0);
+    CHECK(s_closed_dest[9] == -1);      // 不是 TCP Client 目标，没有断开通知
+    CHECK(ch->uart_state == UART_STATE_CLOSED);
+    CHECK(g_channel_active_mask == 0);
+}
+
+static void test_invalid_baudrate(void)
+{
+    ChannelState *ch = &g_system_config.channels[6];
+
+    setup_channel(6, OP_MODE_TCP_CLIENT, 0);
+    hand_off(6, CONN_TYPE_TCPCLIENT, 0, 0);
+    CHECK(ch->data_net_info.num_clients == 1);
+    CHECK(s_uart[6].calls == 0);
+    CHECK(ch->uart_state != UART_STATE_OPENED);
+    CHECK(g_channel_active_mask == 0);
+    CHECK(g_channel_client_mask == (1u << 6));
+    cleanup_data_connection(6, 0);
+    CHECK(ch->uart_state == UART_STATE_CLOSED);
+    CHECK(g_channel_client_mask == 0);
+}
+
+int main(void)
+{
+    g_config_mutex = semMCreate(SEM_Q_PRIORITY);
+    CHECK(buf_pool_init() == OK);
+    CHECK(poll_set_init() == OK);
+    test_tcp_client();
+    test_udp();
+    test_invalid_baudrate();
+    return test_report("test_net_handoff");
+}
@@ -0,0 +1,212 @@
+/*
+ * hal_pollset 就绪集合的语义，主机上的 epoll 实现和 VxWorks 上的持久 fd_set + select()
+ * 实现 (以 -U__linux__ 编译 hal_pollset.c) 使用同一组检查。
+ *
+ * 与网络调度任务相同的规模: 16通道 x 8客户端 = 128 个 socketpair，tag 为 (通道 << 8) | 槽位。
+ * 检查登记/修改/注销的返回值、只返回就绪的 fd 及其 tag、电平触发 (数据读走前一直就绪)、
+ * 对端关闭按可读返回、可写事件只在关注时返回，以及 max_events 截断后剩余事件不丢失。
+ */
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "hal_pollset.h"
+#include "test_common.h"
+
+#ifndef POLL_SET_BACKEND
+#define POLL_SET_BACKEND "epoll"
+#endif
+
+#define CHANNELS    (16)
+#define CLIENTS     (8)
+#define NUM_PAIRS   (CHANNELS * CLIENTS)
+
+static int s_fd[NUM_PAIRS];         // 登记到集合中的一端
+static int s_peer[NUM_PAIRS];       // 测试从这一端写入/关闭
+
+static uint32_t tag_of(int k)
+{
+    return ((uint32_t)(k / CLIENTS) << 8) | (uint32_t)(k % CLIENTS);
+}
+
+static int index_of_fd(int fd)
+{
+    int k;
+
+    for (k = 0; k < NUM_PAIRS; k++) {
+        if (s_fd[k] == fd) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+static void drain(int k)
+{
+    char buf[256];
+
+    while (read(s_fd[k], buf, sizeof(buf)) > 0) {
+    }
+}
+
+/* 等待一次，ready[k] 为第 k 对 socket 返回的事件，检查 tag 与 fd 一致；返回就绪事件数 */
+static int wait_once(uint32_t *ready, int max_events)
+{
+    poll_event_t ev[POLL_SET_MAX_FDS];
+    int n, j;
+
+    memset(ready, 0, NUM_PAIRS * sizeof(ready[0]));
+    n = poll_set_wait(ev, max_events, 0);
+    for (j = 0; j < n; j++) {
+        int k = index_of_fd(ev[j].fd);
+
+        CHECK(k >= 0);
+        if (k < 0) {
+            continue;
+        }
+        CHECK(ev[j].tag == tag_of(k));
+        CHECK(ready[k] == 0);               // 同一个 fd 只返回一次
+        ready[k] = ev[j].events;
+    }
+    return n;
+}
+
+static void test_register(void)
+{
+    int k;
+
+    CHECK(poll_set_init() == OK);
+    for (k = 0; k < NUM_PAIRS; k++) {
+        int sv[2];
+
+        CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        s_fd[k] = sv[0];
+        s_peer[k] = sv[1];
+        fcntl(s_fd[k], F_SETFL, O_NONBLOCK);
+        CHECK(poll_set_add(s_fd[k], POLL_SET_IN, tag_of(k)) == OK);
+    }
+    // 重复登记、修改/注销未登记的 fd 都返回 ERROR
+    CHECK(poll_set_add(s_fd[5], POLL_SET_IN, 0) == ERROR);
+    CHECK(poll_set_modify(s_peer[5], POLL_SET_IN, 0) == ERROR);
+    CHECK(poll_set_remove(s_peer[5]) == ERROR);
+}
+
+static void test_readable(void)
+{
+    static const int picks[] = { 0, 7, 8, 63, 64, 100, 127 };
+    uint32_t ready[NUM_PAIRS];
+    size_t j;
+    int k, n;
+
+    // 没有数据时立即返回0
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+
+    for (j = 0; j < sizeof(picks) / sizeof(picks[0]); j++) {
+        CHECK(write(s_peer[picks[j]], "x", 1) == 1);
+    }
+    n = wait_once(ready, POLL_SET_MAX_FDS);
+    CHECK(n == (int)(sizeof(picks) / sizeof(picks[0])));
+    for (j = 0; j < sizeof(picks) / sizeof(picks[0]); j++) {
+        CHECK(ready[picks[j]] == POLL_SET_IN);
+    }
+
+    // 电平触发: 读走之前再次等待仍然返回
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == n);
+    for (j = 0; j < sizeof(picks) / sizeof(picks[0]); j++) {
+        drain(picks[j]);
+    }
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+
+    // max_events 截断: 每次最多返回 max_events 个，读走后其余的在后续等待中返回
+    for (k = 0; k < NUM_PAIRS; k += 3) {
+        CHECK(write(s_peer[k], "y", 1) == 1);
+    }
+    for (;;) {
+        n = wait_once(ready, 4);
+        CHECK(n <= 4);
+        if (n <= 0) {
+            break;
+        }
+        for (k = 0; k < NUM_PAIRS; k++) {
+            if (ready[k]) {
+                CHECK(k % 3 == 0);
+                drain(k);
+            }
+        }
+    }
+    for (k = 0; k < NUM_PAIRS; k += 3) {
+        char c;
+        CHECK(read(s_fd[k], &c, 1) < 0);    // 全部已在某次等待中返回并读走
+    }
+}
+
+static void test_writable_and_modify(void)
+{
+    uint32_t ready[NUM_PAIRS];
+
+    // 只关注可读时，可写的 socket 不返回
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+
+    // 改为同时关注可写，tag 随之更新
+    CHECK(poll_set_modify(s_fd[20], POLL_SET_IN | POLL_SET_OUT, 0xABCD) == OK);
+    {
+        poll_event_t ev[4];
+
+        CHECK(poll_set_wait(ev, 4, 0) == 1);
+        CHECK(ev[0].fd == s_fd[20] && ev[0].tag == 0xABCD && ev[0].events == POLL_SET_OUT);
+        CHECK(write(s_peer[20], "z", 1) == 1);
+        CHECK(poll_set_wait(ev, 4, 0) == 1);
+        CHECK(ev[0].events == (POLL_SET_IN | POLL_SET_OUT));
+        drain(20);
+    }
+    CHECK(poll_set_modify(s_fd[20], POLL_SET_IN, tag_of(20)) == OK);
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+
+    // 关注的事件为0时不返回，即使有数据
+    CHECK(poll_set_modify(s_fd[21], 0, tag_of(21)) == OK);
+    CHECK(write(s_peer[21], "z", 1) == 1);
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+    CHECK(poll_set_modify(s_fd[21], POLL_SET_IN, tag_of(21)) == OK);
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 1 && ready[21] == POLL_SET_IN);
+    drain(21);
+}
+
+static void test_close_and_remove(void)
+{
+    uint32_t ready[NUM_PAIRS];
+    int k;
+
+    // 对端关闭按可读返回 (recv() 读到0后由调用者清理连接)
+    close(s_peer[90]);
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 1 && ready[90] == POLL_SET_IN);
+    CHECK(poll_set_remove(s_fd[90]) == OK);
+    CHECK(poll_set_remove(s_fd[90]) == ERROR);
+    close(s_fd[90]);
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+
+    // 注销后的 fd 即使有数据也不返回，重新登记后恢复
+    CHECK(poll_set_remove(s_fd[127]) == OK);
+    CHECK(write(s_peer[127], "w", 1) == 1);
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+    CHECK(poll_set_add(s_fd[127], POLL_SET_IN, tag_of(127)) == OK);
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 1 && ready[127] == POLL_SET_IN);
+    drain(127);
+
+    // 全部注销后集合为空
+    for (k = 0; k < NUM_PAIRS; k++) {
+        if (k != 90) {
+            CHECK(poll_set_remove(s_fd[k]) == OK);
+            CHECK(write(s_peer[k], "v", 1) == 1);
+        }
+    }
+    CHECK(wait_once(ready, POLL_SET_MAX_FDS) == 0);
+}
+
+int main(void)
+{
+    test_register();
+    test_readable();
+    test_writable_and_modify();
+    test_close_and_remove();
+    return test_report("test_pollset (" POLL_SET_BACKEND ")");
+}
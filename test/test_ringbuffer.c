@@ -0,0 +1,164 @@
+/*
+ * ring_buffer_t 的批量复制路径 (最多两段 memcpy) 在每个回绕位置上的正确性。
+ *
+ * 对每个起始偏移、每个初始填充量和每个写入长度，批量写入/读出的结果都与逐字节的
+ * 参考模型 (覆盖最旧数据 / 放不下的不写入) 比较。起始索引还放在计数器回绕点附近，
+ * 覆盖自由运行的 head/tail 越过 ring_buffer_size_t 最大值的情况。
+ */
+#include <string.h>
+#include "hal_ringbuffer.h"
+#include "test_common.h"
+
+#define CAP      (32)
+#define MAX_LEN  (2 * CAP + 1)
+
+/* 逐字节参考模型 */
+typedef struct {
+    char data[CAP];
+    int n;
+} ref_t;
+
+static void ref_push(ref_t *r, char c, int overwrite)
+{
+    if (r->n == CAP) {
+        if (!overwrite) {
+            return;
+        }
+        memmove(r->data, r->data + 1, CAP - 1);
+        r->n--;
+    }
+    r->data[r->n++] = c;
+}
+
+static int ref_pop(ref_t *r, char *out, int len)
+{
+    if (len > r->n) {
+        len = r->n;
+    }
+    memcpy(out, r->data, len);
+    memmove(r->data, r->data + len, r->n - len);
+    r->n -= len;
+    return len;
+}
+
+static char s_mem[CAP];
+static char s_src[MAX_LEN];
+
+/* 建立起始索引为 start、已有 fill 个字节的缓冲区及其参考模型 */
+static void setup(ring_buffer_t *rb, ref_t *ref, ring_buffer_size_t start, int fill)
+{
+    int k;
+
+    memset(s_mem, 0x5A, sizeof(s_mem));
+    ring_buffer_init(rb, s_mem, sizeof(s_mem));
+    rb->head_index = rb->tail_index = rb->peek_index = start;
+    ref->n = 0;
+    for (k = 0; k < fill; k++) {
+        ring_buffer_queue(rb, (char)(0x80 + k));
+        ref_push(ref, (char)(0x80 + k), 1);
+    }
+}
+
+/* 按 chunk 字节一批读出全部内容并与参考模型比较 */
+static void drain_and_compare(ring_buffer_t *rb, ref_t *ref, int chunk)
+{
+    char got[CAP], want[CAP];
+    int n, m;
+
+    CHECK(ring_buffer_num_items(rb) == (ring_buffer_size_t)ref->n);
+    do {
+        n = (int)ring_buffer_dequeue_arr(rb, got, chunk);
+        m = ref_pop(ref, want, chunk);
+        CHECK(n == m);
+        CHECK(memcmp(got, want, m) == 0);
+    } while (m > 0);
+    CHECK(ring_buffer_is_empty(rb));
+}
+
+static void test_offsets(ring_buffer_size_t base)
+{
+    ring_buffer_t rb;
+    ref_t ref;
+    int off, fill, len, k;
+
+    for (k = 0; k < MAX_LEN; k++) {
+        s_src[k] = (char)k;
+    }
+    for (off = 0; off < CAP; off++) {
+        for (fill = 0; fill <= CAP; fill++) {
+            for (len = 0; len <= MAX_LEN; len++) {
+                ring_buffer_size_t lost;
+                int chunk = 1 + (off + len) % 7;
+
+                /* 覆盖最旧数据 (单上下文) */
+                setup(&rb, &ref, base + off, fill);
+                ring_buffer_queue_arr(&rb, s_src, len);
+                for (k = 0; k < len; k++) {
+                    ref_push(&ref, s_src[k], 1);
+                }
+                drain_and_compare(&rb, &ref, chunk);
+
+                /* SPSC 生产者: 放不下的部分不写入 */
+                setup(&rb, &ref, base + off, fill);
+                CHECK(ring_buffer_spsc_queue_arr(&rb, s_src, len)
+                      == (ring_buffer_size_t)((len < CAP - fill) ? len : CAP - fill));
+                for (k = 0; k < len; k++) {
+                    ref_push(&ref, s_src[k], 0);
+                }
+                drain_and_compare(&rb, &ref, chunk);
+
+                /* SPSC 生产者: 覆盖最旧数据，返回丢失的字节数 */
+                setup(&rb, &ref, base + off, fill);
+                lost = ring_buffer_spsc_overwrite_arr(&rb, s_src, len);
+                CHECK(lost == (ring_buffer_size_t)((fill + len > CAP) ? fill + len - CAP : 0));
+                for (k = 0; k < len; k++) {
+                    ref_push(&ref, s_src[k], 1);
+                }
+                drain_and_compare(&rb, &ref, chunk);
+            }
+        }
+    }
+}
+
+/* 原地读写的两段接口: reserve/commit 与 peek_spans_at 在每个偏移上覆盖完整的区域 */
+static void test_spans(ring_buffer_size_t base)
+{
+    ring_buffer_t rb;
+    ref_t ref;
+    int off, fill;
+
+    for (off = 0; off < CAP; off++) {
+        for (fill = 0; fill <= CAP; fill++) {
+            char *span[2];
+            ring_buffer_size_t span_len[2], total, n;
+            char *w;
+            int k = 0;
+
+            setup(&rb, &ref, base + off, fill);
+            total = ring_buffer_peek_spans_at(&rb, ring_buffer_tail(&rb), CAP, span, span_len);
+            CHECK(total == (ring_buffer_size_t)fill);
+            CHECK(span_len[0] + span_len[1] == total);
+            CHECK(memcmp(span[0], ref.data, span_len[0]) == 0);
+            CHECK(memcmp(span[1], ref.data + span_len[0], span_len[1]) == 0);
+
+            /* 两次 reserve 恰好填满剩余空间 */
+            while ((n = ring_buffer_reserve(&rb, &w)) > 0) {
+                memset(w, 0x11, n);
+                ring_buffer_commit(&rb, n);
+                k += (int)n;
+            }
+            CHECK(k == CAP - fill);
+            CHECK(ring_buffer_is_full(&rb));
+        }
+    }
+}
+
+int main(void)
+{
+    /* 普通起始位置，以及计数器回绕点之前 (目标板上 ring_buffer_size_t 为32位时即 UINT32_MAX 附近) */
+    test_offsets(0);
+    test_offsets((ring_buffer_size_t)0 - 2 * CAP);
+    test_spans(0);
+    test_spans((ring_buffer_size_t)0 - CAP / 2);
+    return test_report("test_ringbuffer");
+}
@@ -0,0 +1,149 @@
+/*
+ * ring_buffer_t 单生产者/单消费者路径的双线程压力测试。
+ *
+ * 生产者线程用 ring_buffer_spsc_queue_arr() 写入按位置编号的字节流，消费者线程
+ * 分别用数据通路上的两种消费方式读出并逐字节核对，任何丢失、重复或乱序都会被发现：
+ * - peek_span/consume (buffer_net -> 串口)；
+ * - peek_spans_at/release_to (buffer_uart -> 多个网络客户端的读游标)。
+ * head/tail 的初值放在计数器回绕点之前 (目标板上 ring_buffer_size_t 为32位，
+ * 即 UINT32_MAX 附近)，测试过程中索引越过回绕点。
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "hal_ringbuffer.h"
+#include "test_common.h"
+
+#define RING_SIZE    (256)
+#define STREAM_BYTES (32u * 1024 * 1024)
+
+typedef struct {
+    ring_buffer_t rb;
+    int use_cursor;                 /* 1: peek_spans_at/release_to，0: peek_span/consume */
+    size_t errors;
+} stress_t;
+
+static char s_mem[RING_SIZE];
+
+/* 流中第 pos 个字节的值 */
+static inline char stream_byte(size_t pos)
+{
+    return (char)(pos * 7 + (pos >> 8));
+}
+
+static void *producer(void *arg)
+{
+    stress_t *st = arg;
+    char chunk[97];
+    size_t produced = 0;
+    size_t n = 1;
+
+    while (produced < STREAM_BYTES) {
+        size_t k, done;
+
+        /* 块大小在 1..97 之间变化，写入位置与回绕点的关系不断变化 */
+        n = (n * 13 + 5) % sizeof(chunk) + 1;
+        if (n > STREAM_BYTES - produced) {
+            n = STREAM_BYTES - produced;
+        }
+        for (k = 0; k < n; k++) {
+            chunk[k] = stream_byte(produced + k);
+        }
+        done = 0;
+        while (done < n) {
+            ring_buffer_size_t q = ring_buffer_spsc_queue_arr(&st->rb, chunk + done, n - done);
+            if (q == 0) {
+                sched_yield(); /* 单核主机上让出CPU给消费者 */
+            }
+            done += q;
+        }
+        produced += n;
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    stress_t *st = arg;
+    size_t consumed = 0;
+    size_t limit = 1;
+
+    while (consumed < STREAM_BYTES) {
+        char *span[2];
+        ring_buffer_size_t span_len[2];
+        ring_buffer_size_t k, total;
+        int s;
+
+        limit = (limit * 11 + 3) % 131 + 1;
+        if (st->use_cursor) {
+            ring_buffer_size_t cursor = ring_buffer_tail(&st->rb);
+
+            total = ring_buffer_peek_spans_at(&st->rb, cursor, limit, span, span_len);
+            for (s = 0; s < 2; s++) {
+                for (k = 0; k < span_len[s]; k++) {
+                    if (span[s][k] != stream_byte(consumed++)) {
+                        st->errors++;
+                    }
+                }
+            }
+            ring_buffer_release_to(&st->rb, cursor + total);
+        } else {
+            total = ring_buffer_peek_span(&st->rb, &span[0]);
+            if (total > limit) {
+                total = limit;
+            }
+            for (k = 0; k < total; k++) {
+                if (span[0][k] != stream_byte(consumed++)) {
+                    st->errors++;
+                }
+            }
+            ring_buffer_consume(&st->rb, total);
+        }
+        if (ring_buffer_num_items(&st->rb) > RING_SIZE) {
+            st->errors++;
+        }
+        if (total == 0) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void run(ring_buffer_size_t seed, int use_cursor)
+{
+    stress_t st;
+    pthread_t p, c;
+
+    memset(&st, 0, sizeof(st));
+    ring_buffer_init(&st.rb, s_mem, sizeof(s_mem));
+    st.rb.head_index = st.rb.tail_index = st.rb.peek_index = seed;
+    st.use_cursor = use_cursor;
+
+    pthread_create(&c, NULL, consumer, &st);
+    pthread_create(&p, NULL, producer, &st);
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+
+    CHECK(st.errors == 0);
+    CHECK(ring_buffer_is_empty(&st.rb));
+    CHECK(ring_buffer_head(&st.rb) == seed + STREAM_BYTES);
+    printf("seed=%#zx %-22s errors=%zu\n", (size_t)seed,
+           use_cursor ? "peek_spans_at/release" : "peek_span/consume", st.errors);
+}
+
+int main(void)
+{
+    static const ring_buffer_size_t seeds[] = {
+        0,
+        (ring_buffer_size_t)0 - 1,                  /* 第一个字节就越过回绕点 */
+        (ring_buffer_size_t)0 - RING_SIZE / 2 - 3,  /* 回绕点落在缓冲区中间且不对齐 */
+        (ring_buffer_size_t)0 - 1000003,            /* 运行中途越过回绕点 */
+    };
+    size_t k;
+
+    for (k = 0; k < sizeof(seeds) / sizeof(seeds[0]); k++) {
+        run(seeds[k], 0);
+        run(seeds[k], 1);
+    }
+    return test_report("test_ringbuffer_spsc");
+}
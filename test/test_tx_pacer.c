@@ -0,0 +1,160 @@
+/*
+ * 串口发送节拍 (serial_tx_room) 在时间戳计数器回绕时的行为。
+ *
+ * 直接包含 app_realtime.c，用一个发送FIFO模型替换 hal_axi16550 的接口: FIFO 按实际波特率
+ * 发出字符，写入超过 UART_HW_FIFO_SIZE 的字节计为溢出 (实际硬件上丢失)。sysTimestamp() 每
+ * TS_PERIOD 个计数回零一次 (常见为一个系统 tick)，tSerialIO 每 PASS_COUNTS 个计数执行一个周期。
+ * 线路连续忙碌、持续时间远超计数器周期时检查:
+ * - FIFO 从不溢出；
+ * - 线路保持忙碌: 推算按 64/65 的线路速率计，误差累积到约一个FIFO (约1.6万个字符) 时
+ *   FIFO 会发空一次并重新对齐，空闲时间只占很小的比例。
+ */
+#include <string.h>
+#include "../APP/app_realtime.c"
+#include "host_stubs.h"
+#include "test_common.h"
+
+#define PORT            (7)
+#define BAUD            (921600)
+#define BITS_PER_CH     (10)                    // 8N1
+#define TS_FREQ         (100000000u)            // host_stubs.c 的 sysTimestampFreq()
+#define TS_PERIOD       (100000u)               // 1ms 回零一次
+#define PASS_COUNTS     (10000u)                // 100us 一个周期
+#define SIM_PASSES      (20000)                 // 2s，约 18 万个字符
+#define RING_SIZE       (4096)
+
+static char s_mem[2][RING_SIZE];
+static UINT64 s_now;                            // 模拟的绝对时间 (时间戳计数)
+static UINT64 s_fifo_drained_at;                // FIFO 中的字节按实际波特率发完的时刻
+static uint32_t s_fifo_overflow;
+static uint32_t s_fifo_written;
+static UINT64 s_line_idle;                      // 首次写入后线路空闲 (FIFO 已发空) 的累计时间
+
+SystemConfiguration g_system_config;
+volatile uint32_t g_channel_active_mask;
+
+/* ------------------ 发送FIFO模型 ------------------ */
+
+/* 实际每个字符的时间戳计数 */
+static double char_counts(void)
+{
+    return (double)BITS_PER_CH * TS_FREQ / BAUD;
+}
+
+static uint32_t fifo_level(void)
+{
+    if (s_fifo_drained_at <= s_now) {
+        return 0;
+    }
+    // 正在发送的字符仍占一个位置，向上取整
+    return (uint32_t)((s_fifo_drained_at - s_now) / char_counts() + 0.999999);
+}
+
+int axi16550SendNoWait(unsigned int channel, uint8_t *buffer, uint32_t len)
+{
+    uint32_t level = fifo_level();
+
+    if (level + len > UART_HW_FIFO_SIZE) {
+        s_fifo_overflow += level + len - UART_HW_FIFO_SIZE;
+    }
+    if (s_fifo_drained_at < s_now) {
+        if (s_fifo_written > 0) {
+            s_line_idle += s_now - s_fifo_drained_at;
+        }
+        s_fifo_drained_at = s_now;
+    }
+    s_fifo_drained_at += (UINT64)(len * char_counts());
+    s_fifo_written += len;
+    return 0;
+}
+
+uint32_t UART_TX_Empty_Mask(void)
+{
+    return (fifo_level() == 0) ? (1u << PORT) : 0;
+}
+
+uint32_t UART_RX_Ready_Mask(void) { return 0; }
+int axi16550RecvBurst(unsigned int channel, uint8_t *buffer, uint32_t known, uint32_t max, uint32_t *len)
+{
+    *len = 0;
+    return 0;
+}
+int axi16550_TxReady(unsigned int channel) { return fifo_level() == 0; }
+uint32_t axi16550RxTriggerBytes(unsigned int level) { return 1; }
+unsigned int axi16550IntId(unsigned int channel) { return IIR_NO_INT; }
+void axi16550IntEnable(unsigned int channel, unsigned int ier) {}
+void axi165502CInit(usart_info_t *uart_instance, int channel) {}
+void txled(int i, int action) {}
+void rxled(int i, int action) {}
+
+/* ------------------ app_realtime.c 依赖的其他模块 ------------------ */
+
+void log_printf(LogLevel level, const char *file, int line, const char *format, ...) {}
+/* 与 hal_timer.c 相同: 计数器每 TS_PERIOD 回零一次，只能处理一次回绕 */
+UINT32 hal_timestamp_elapsed(UINT32 start, UINT32 end)
+{
+    if (end >= start) {
+        return end - start;
+    }
+    return end + TS_PERIOD - start;
+}
+UINT32 hal_timestamp_to_us(UINT32 ticks) { return ticks; }
+void app_start_hz(int unit, int hz) {}
+STATUS app_register_task(APP_TASK_CALLBACK func, void *arg) { return OK; }
+void packer_gap_rx(int channel_index, ring_buffer_size_t start, UINT32 clock) {}
+void packer_gap_poll(UINT32 clock) {}
+BOOL packer_gap_pending(void) { return FALSE; }
+void net_scheduler_notify_rx(int channel_index, ring_buffer_size_t fill_before) {}
+void net_scheduler_notify_tx(int channel_index) {}
+STATUS channel_buffers_attach(int channel_index) { return OK; }
+void dev_channel_activity_update(int channel_index) {}
+
+/* ------------------ 测试 ------------------ */
+
+static void test_wrap(void)
+{
+    ChannelState *ch = &g_system_config.channels[PORT];
+    ChannelRuntime *rt = &g_system_config.runtime[PORT];
+    static char data[RING_SIZE];
+    UINT64 start;
+    double util;
+    int k;
+
+    ring_buffer_init(&rt->buffer_net, s_mem[0], RING_SIZE);
+    ring_buffer_init(&rt->buffer_uart, s_mem[1], RING_SIZE);
+    ch->baudrate = BAUD;
+    ch->data_bits = 8;
+    ch->stop_bits = 1;
+    ch->parity = 0;
+    g_channel_active_mask = 1u << PORT;
+    serial_tx_pacer_update();
+    CHECK(s_tx_pacer[PORT].char_q8 != 0);
+
+    // 计数器从接近回零处开始
+    s_now = TS_PERIOD - 3 * PASS_COUNTS;
+    start = s_now;
+    for (k = 0; k < SIM_PASSES; k++) {
+        // 网络侧保持 buffer_net 有数据，线路应连续忙碌
+        ring_buffer_queue_arr(&rt->buffer_net, data, ring_buffer_num_free(&rt->buffer_net));
+        host_timestamp = (UINT32)(s_now % TS_PERIOD);
+        run_high_frequency_tasks(SERIAL_IO_NO_BUDGET);
+        s_now += PASS_COUNTS;
+    }
+
+    // 推算的字节数不小于实际值，从不多写
+    CHECK(s_fifo_overflow == 0);
+    // 每两个周期补充一次 (收发交替)，FIFO 可容纳约 2.8ms 的数据
+    util = 1.0 - (double)s_line_idle / (double)(s_now - start);
+    CHECK(util > 0.99);
+    CHECK(s_tx_pacer[PORT].underruns <= s_fifo_written / (UART_HW_FIFO_SIZE * 64) + 1);
+    CHECK(rt->tx_count == s_fifo_written);
+    printf("tx pacer: %u bytes in %.1f ms, line busy %.2f%%, underruns %u, overflow %u\n",
+           s_fifo_written, (s_now - start) * 1000.0 / TS_FREQ, util * 100,
+           s_tx_pacer[PORT].underruns, s_fifo_overflow);
+}
+
+int main(void)
+{
+    test_wrap();
+    return test_report("test_tx_pacer");
+}